@@ -16,6 +16,7 @@
 #include "system/systemobject.h"
 #include "system/observable.h"
 #include "system/events.h"
+#include "system/psram.h"
 #include "ui/settings_view.h"
 #include "ui/wifisettings.h"
 #include "ui/signalk_settings.h"
@@ -315,6 +316,8 @@ char *Gui::message_from_code(GuiMessageCode_t code)
 
 void Gui::on_power_event(PowerCode_t code, uint32_t arg)
 {
+    dynamic_gui->handle_power_event(code);
+
     if (code == PowerCode_t::POWER_LEAVE_LOW_POWER)
     {
         auto ttgo = TTGOClass::getWatch();
@@ -534,28 +537,23 @@ void Gui::handle_gui_queue()
                 }
             }
         }
-        else if (event.event_type == GuiEventType_t::GUI_SK_DV_UPDATE)
-        {
-            StaticJsonDocument<512> update;
-            auto result = deserializeJson(update, event.argument);
-
-            if (result == DeserializationError::Ok)
-            {
-                auto path = update["path"].as<String>();
-                auto value = update["value"].as<JsonVariant>();
-                dynamic_gui->handle_signalk_update(path, value);
-            }
-            else
-            {
-                ESP_LOGI(GUI_TAG, "Unable to parse json, error=%s", result.c_str());
-            }
-        }
 
         if (event.argument != NULL)
         {
             free(event.argument);
         }
     }
+
+    ws_socket->process_put_requests();
+
+    SignalKUpdate_t update;
+    char *spill;
+
+    while (read_gui_sk_dv_update(update, &spill))
+    {
+        dynamic_gui->handle_signalk_update(update.path_id, update.value, spill);
+        twatchsk::psram_free(spill);
+    }
 }
 
 void Gui::lv_battery_task(struct _lv_task_t *data)
@@ -650,6 +648,7 @@ void Gui::lv_mainbar_callback(lv_obj_t *obj, lv_event_t event)
         lv_tileview_get_tile_act(obj, &x, &y);
         ESP_LOGI(GUI_TAG, "Tile view is showing location %d,%d", x, y);
         gui->set_is_active_view_dynamic(x > 0);
+        gui->dynamic_gui->set_active_view(x - 1);
         gui->update_arrows_visibility();
     }
 }
@@ -927,6 +926,7 @@ void Gui::show_settings()
 void Gui::show_home()
 {    
     lv_tileview_set_tile_act(dynamic_gui->get_tile_view(), 0, 0, LV_ANIM_ON);
+    dynamic_gui->set_active_view(-1);
 }
 
 void Gui::toggle_wifi()
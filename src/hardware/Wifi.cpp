@@ -6,10 +6,13 @@
 #include "esp_system.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
+#include <time.h>
 
 #include "lwip/err.h"
 #include "lwip/sys.h"
+#include "lwip/ip4_addr.h"
 #include "system/events.h"
 #include "system/async_dispatcher.h"
 
@@ -18,6 +21,7 @@ static bool scan_done = false;
 static bool scan_running = false;
 static wifi_ap_record_t ap_info[WIFI_AP_LIST_MAX_SIZE];
 static uint16_t ap_count = 0;
+static const char *connect_path_names[WIFI_PATH_COUNT] = {"full", "fast", "fast static IP"};
 
 void WifiManager::wifi_event_handler(void *arg, esp_event_base_t event_base,
                                      int32_t event_id, void *event_data)
@@ -26,6 +30,7 @@ void WifiManager::wifi_event_handler(void *arg, esp_event_base_t event_base,
 
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
     {
+        manager->apply_ip_config();
         esp_wifi_connect();
     }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
@@ -37,15 +42,23 @@ void WifiManager::wifi_event_handler(void *arg, esp_event_base_t event_base,
         {
             if (manager->is_enabled())
             {
-                if (manager->value == WifiState_t::Wifi_Connecting)
+                if (manager->value == WifiState_t::Wifi_Connecting && manager->connect_path_ != WIFI_PATH_FULL)
                 {
-                    post_gui_warning(GuiMessageCode_t::GUI_WARN_WIFI_CONNECTION_FAILED);   
+                    // cached AP isn't there anymore (moved, other AP of the same network), user isn't bothered - full connect follows
+                    manager->fallback_to_full_connect();
                 }
-                else // manager->value is WifiState_t::Connected
+                else
                 {
-                    post_gui_warning(GuiMessageCode_t::GUI_WARN_WIFI_DISCONNECTED);
+                    if (manager->value == WifiState_t::Wifi_Connecting)
+                    {
+                        post_gui_warning(GuiMessageCode_t::GUI_WARN_WIFI_CONNECTION_FAILED);
+                    }
+                    else // manager->value is WifiState_t::Connected
+                    {
+                        post_gui_warning(GuiMessageCode_t::GUI_WARN_WIFI_DISCONNECTED);
+                    }
+                    xTaskCreate(&wifi_reconnect_task, "wifi reconnect task", 2048, manager, 5, NULL);
                 }
-                xTaskCreate(&wifi_reconnect_task, "wifi reconnect task", 2048, manager, 5, NULL);
             }
         }
 
@@ -59,18 +72,12 @@ void WifiManager::wifi_event_handler(void *arg, esp_event_base_t event_base,
         char buff[24];
         sprintf(buff, IPSTR, IP2STR(&event->ip_info.ip));
         manager->set_ip(String(buff));
+        manager->record_time_to_ip();
         manager->update_status(Wifi_Connected);
         //BS: add a new message here: "Wifi reconnected after X attempts"
         //post_gui_warning(GuiMessageCode_t::GUI_WARN_WIFI_RECONNECTED);
         manager->wifi_retry_counter_ = 0; // to be ready for the next disconnect
-
-        if (!manager->is_known_wifi(manager->ssid_)) //add wifi to known list - we need to save it later on
-        {
-            KnownWifi_t wifi;
-            wifi.known_ssid = manager->ssid_;
-            wifi.known_password = manager->password_;
-            manager->known_wifi_list_.push_back(wifi);
-        }
+        manager->update_connection_cache();
     }
     else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
     {
@@ -130,20 +137,29 @@ void WifiManager::initialize()
     }
 }
 
-static void wifi_enable(const char *ssid, const char *password)
+/**
+ * @brief Starts wifi in station mode
+ * @param cached if set, driver connects directly to AP of last connection on its channel instead of scanning all channels
+ **/
+static void wifi_enable(const char *ssid, const char *password, const KnownWifi_t *cached, uint8_t listen_interval)
 {
     wifi_config_t wifi_config;
     memset(&wifi_config, 0, sizeof(wifi_config_t));
     strcpy(reinterpret_cast<char *>(wifi_config.sta.ssid), ssid);
     strcpy(reinterpret_cast<char *>(wifi_config.sta.password), password);
-    wifi_config.sta.listen_interval = 9;
+    wifi_config.sta.listen_interval = listen_interval;
+
+    if (cached != NULL)
+    {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cached->bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = cached->channel;
+        ESP_LOGI(WIFI_TAG, "wifi_enable(): Fast connect to " MACSTR " on channel %d.", MAC2STR(cached->bssid), cached->channel);
+    }
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
-
-    ESP_LOGI(WIFI_TAG, "wifi_enable(): esp_wifi_set_ps().");
-    esp_wifi_set_ps(WIFI_PS_MAX_MODEM);
 }
 
 static void disable_wifi()
@@ -160,6 +176,7 @@ void WifiManager::clear_wifi_list()
 
 WifiManager::WifiManager() : Configurable("/config/wifi"), SystemObject("wifi"), Observable(Wifi_Off)
 {
+    known_wifi_lock_ = xSemaphoreCreateMutex();
     load();
     initialize();
 
@@ -174,8 +191,14 @@ void WifiManager::on()
     if (!ssid_.isEmpty())
     {
         enabled_ = true;
-        wifi_enable(ssid_.c_str(), password_.c_str());
-        ESP_LOGI(WIFI_TAG, "WifiManager::on(): Wifi has been enabled, SSID=%s.", ssid_.c_str());
+        KnownWifi_t known;
+        bool is_known = get_known_wifi(ssid_, known);
+        connect_path_ = select_connect_path(is_known ? &known : NULL);
+        connect_start_us_ = esp_timer_get_time();
+        // listen interval is told to AP when associating, AP buffers frames for us that long even when we switch profiles later
+        wifi_enable(ssid_.c_str(), password_.c_str(), connect_path_ != WIFI_PATH_FULL ? &known : NULL, listen_interval_);
+        apply_power_profile(is_low_power());
+        ESP_LOGI(WIFI_TAG, "WifiManager::on(): Wifi has been enabled, SSID=%s, %s connect.", ssid_.c_str(), connect_path_names[connect_path_]);
         update_status(Wifi_Connecting);
     }
     else
@@ -197,26 +220,70 @@ void WifiManager::off(bool force)
     }
 }
 
+static String ip_to_string(uint32_t address)
+{
+    char buff[16];
+    ip4_addr_t ip;
+    ip.addr = address;
+    return String(ip4addr_ntoa_r(&ip, buff, sizeof(buff)));
+}
+
+static uint32_t string_to_ip(JsonVariantConst value)
+{
+    ip4_addr_t ip;
+    const char *text = value.as<const char *>();
+
+    if (text == NULL || !ip4addr_aton(text, &ip))
+    {
+        return 0;
+    }
+
+    return ip.addr;
+}
+
 void WifiManager::save_config_to_file(JsonObject &json)
 {
     ESP_LOGI(WIFI_TAG, "Storing SSID %s to JSON.", ssid_.c_str());
     json["enabled"] = enabled_;
     json["ssid"] = ssid_;
     json["password"] = password_;
+    json["ps"] = (int)awake_ps_mode_;
+    json["lpps"] = (int)low_power_ps_mode_;
+    json["lplisten"] = listen_interval_;
     JsonArray knownList = json.createNestedArray("known");
+    xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
     for (int i = 0; i < known_wifi_list_.size(); i++)
     {
         JsonObject known = knownList.createNestedObject();
         auto wifiInfo = known_wifi_list_.at(i);
         known["ssid"] = wifiInfo.known_ssid;
         known["password"] = wifiInfo.known_password;
+        if (wifiInfo.channel != 0)
+        {
+            char bssid[18];
+            sprintf(bssid, MACSTR, MAC2STR(wifiInfo.bssid));
+            known["bssid"] = bssid;
+            known["channel"] = wifiInfo.channel;
+        }
+        if (wifiInfo.static_ip)
+        {
+            known["static"] = true;
+            known["ip"] = ip_to_string(wifiInfo.ip);
+            known["netmask"] = ip_to_string(wifiInfo.netmask);
+            known["gateway"] = ip_to_string(wifiInfo.gateway);
+            known["dns"] = ip_to_string(wifiInfo.dns);
+        }
     }
+    xSemaphoreGive(known_wifi_lock_);
 }
 
 void WifiManager::load_config_from_file(const JsonObject &json)
 {
     enabled_ = json["enabled"].as<bool>();
     setup(json["ssid"].as<String>(), json["password"].as<String>());
+    awake_ps_mode_ = (wifi_ps_type_t)(json["ps"] | (int)WIFI_PS_MIN_MODEM);
+    low_power_ps_mode_ = (wifi_ps_type_t)(json["lpps"] | (int)WIFI_PS_MAX_MODEM);
+    listen_interval_ = json["lplisten"] | WIFI_LISTEN_INTERVAL_DEFAULT;
 
     if (json.containsKey("known"))
     {
@@ -227,7 +294,28 @@ void WifiManager::load_config_from_file(const JsonObject &json)
             KnownWifi_t wifiInfo;
             wifiInfo.known_ssid = known["ssid"].as<String>();
             wifiInfo.known_password = known["password"].as<String>();
+            if (known.containsKey("bssid") &&
+                sscanf(known["bssid"].as<const char *>(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &wifiInfo.bssid[0], &wifiInfo.bssid[1],
+                       &wifiInfo.bssid[2], &wifiInfo.bssid[3], &wifiInfo.bssid[4], &wifiInfo.bssid[5]) == 6)
+            {
+                wifiInfo.channel = known["channel"].as<uint8_t>();
+            }
+            // addresses are used only when configured as static, DHCP leases are never reused as static IP
+            wifiInfo.ip = string_to_ip(known["ip"]);
+            wifiInfo.static_ip = known["static"].as<bool>() && wifiInfo.ip != 0;
+            if (wifiInfo.static_ip)
+            {
+                wifiInfo.netmask = string_to_ip(known["netmask"]);
+                wifiInfo.gateway = string_to_ip(known["gateway"]);
+                wifiInfo.dns = string_to_ip(known["dns"]);
+            }
+            else
+            {
+                wifiInfo.ip = 0;
+            }
+            xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
             known_wifi_list_.push_back(wifiInfo);
+            xSemaphoreGive(known_wifi_lock_);
         }
     }
 }
@@ -300,32 +388,21 @@ void WifiManager::connect()
 
 bool WifiManager::is_known_wifi(const String ssid)
 {
-    bool ret = false;
-
-    for (KnownWifi_t wifi : known_wifi_list_)
-    {
-        if (wifi.known_ssid == ssid)
-        {
-            ret = true;
-            break;
-        }
-    }
+    xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
+    bool ret = find_known_wifi(ssid) != NULL;
+    xSemaphoreGive(known_wifi_lock_);
 
     return ret;
 }
 
 bool WifiManager::get_known_wifi_password(const String ssid, String &password)
 {
-    bool ret = false;
+    KnownWifi_t known;
+    bool ret = get_known_wifi(ssid, known);
 
-    for (KnownWifi_t wifi : known_wifi_list_)
+    if (ret)
     {
-        if (wifi.known_ssid == ssid)
-        {
-            password = wifi.known_password;
-            ret = true;
-            break;
-        }
+        password = known.known_password;
     }
 
     return ret;
@@ -341,4 +418,186 @@ int WifiManager::get_wifi_rssi()
     }
 
     return ret;
-}
\ No newline at end of file
+}
+KnownWifi_t *WifiManager::find_known_wifi(const String &ssid)
+{
+    for (auto &wifi : known_wifi_list_)
+    {
+        if (wifi.known_ssid == ssid)
+        {
+            return &wifi;
+        }
+    }
+
+    return NULL;
+}
+
+bool WifiManager::get_known_wifi(const String &ssid, KnownWifi_t &known)
+{
+    xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
+    auto wifi = find_known_wifi(ssid);
+    if (wifi != NULL)
+    {
+        known = *wifi;
+    }
+    xSemaphoreGive(known_wifi_lock_);
+
+    return wifi != NULL;
+}
+
+WifiConnectPath_t WifiManager::select_connect_path(const KnownWifi_t *known)
+{
+    if (known == NULL || known->channel == 0)
+    {
+        return WIFI_PATH_FULL;
+    }
+
+    return known->static_ip ? WIFI_PATH_FAST_IP : WIFI_PATH_FAST;
+}
+
+void WifiManager::apply_ip_config()
+{
+    KnownWifi_t known;
+
+    if (get_known_wifi(ssid_, known) && known.static_ip)
+    {
+        // static IP saves DHCP exchange, interface gets the address as soon as it's associated
+        tcpip_adapter_dhcpc_stop(TCPIP_ADAPTER_IF_STA);
+        tcpip_adapter_ip_info_t ip_info;
+        ip_info.ip.addr = known.ip;
+        ip_info.netmask.addr = known.netmask;
+        ip_info.gw.addr = known.gateway;
+        tcpip_adapter_set_ip_info(TCPIP_ADAPTER_IF_STA, &ip_info);
+
+        if (known.dns != 0)
+        {
+            tcpip_adapter_dns_info_t dns_info;
+            memset(&dns_info, 0, sizeof(dns_info));
+            dns_info.ip.type = IPADDR_TYPE_V4;
+            dns_info.ip.u_addr.ip4.addr = known.dns;
+            tcpip_adapter_set_dns_info(TCPIP_ADAPTER_IF_STA, TCPIP_ADAPTER_DNS_MAIN, &dns_info);
+        }
+        ESP_LOGI(WIFI_TAG, "Using static IP %s.", ip_to_string(known.ip).c_str());
+    }
+    else
+    {
+        // with CONFIG_LWIP_DHCP_RESTORE_LAST_IP client starts with INIT-REBOOT (requests the last lease directly),
+        // it returns error if client is already running, that's fine
+        tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+    }
+}
+
+void WifiManager::update_connection_cache()
+{
+    bool changed = false;
+    wifi_ap_record_t ap;
+    bool has_ap = esp_wifi_sta_get_ap_info(&ap) == ESP_OK;
+
+    xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
+    auto known = find_known_wifi(ssid_);
+    if (known == NULL) //add wifi to known list - we need to save it later on
+    {
+        KnownWifi_t wifi;
+        wifi.known_ssid = ssid_;
+        wifi.known_password = password_;
+        known_wifi_list_.push_back(wifi);
+        known = &known_wifi_list_.back();
+        changed = true;
+    }
+
+    if (has_ap && (known->channel != ap.primary || memcmp(known->bssid, ap.bssid, sizeof(known->bssid)) != 0))
+    {
+        memcpy(known->bssid, ap.bssid, sizeof(known->bssid));
+        known->channel = ap.primary;
+        changed = true;
+    }
+    xSemaphoreGive(known_wifi_lock_);
+
+    if (changed)
+    {
+        // event loop task mustn't wait for flash
+        twatchsk::run_async("Wifi save", [this]()
+                            { save(); });
+    }
+}
+
+void WifiManager::record_time_to_ip()
+{
+    if (value == WifiState_t::Wifi_Connected)
+    {
+        return; // address changed on DHCP renewal
+    }
+
+    auto elapsed = (uint32_t)((esp_timer_get_time() - connect_start_us_) / 1000);
+    auto &stats = connect_stats_[connect_path_];
+    stats.count++;
+    stats.last_ms = elapsed;
+    stats.total_ms += elapsed;
+    ESP_LOGI(WIFI_TAG, "Got IP in %u ms using %s connect (average %u ms of %u).", elapsed, connect_path_names[connect_path_],
+             get_average_time_to_ip(connect_path_), stats.count);
+}
+
+uint32_t WifiManager::get_average_time_to_ip(WifiConnectPath_t path)
+{
+    auto &stats = connect_stats_[path];
+    return stats.count > 0 ? (uint32_t)(stats.total_ms / stats.count) : 0;
+}
+
+void WifiManager::fallback_to_full_connect()
+{
+    ESP_LOGW(WIFI_TAG, "Fast connect failed, trying full connect.");
+
+    xSemaphoreTake(known_wifi_lock_, portMAX_DELAY);
+    auto known = find_known_wifi(ssid_);
+    if (known != NULL)
+    {
+        known->channel = 0;
+        memset(known->bssid, 0, sizeof(known->bssid));
+    }
+    xSemaphoreGive(known_wifi_lock_);
+
+    twatchsk::run_async("Wifi full connect", [this]()
+                        { connect(); });
+}
+
+void WifiManager::apply_power_profile(bool low_power)
+{
+    auto mode = get_power_save_mode(low_power);
+
+    if (enabled_)
+    {
+        auto result = esp_wifi_set_ps(mode);
+        ESP_LOGI(WIFI_TAG, "Power save mode %d (%s profile, ~%u ms/min radio on), result=%d", (int)mode,
+                 low_power ? "low power" : "awake", get_radio_on_estimate(low_power), result);
+    }
+}
+
+void WifiManager::handle_power_event(PowerCode_t code, uint32_t arg)
+{
+    if (code == PowerCode_t::POWER_ENTER_LOW_POWER)
+    {
+        apply_power_profile(true);
+    }
+    else if (code == PowerCode_t::POWER_LEAVE_LOW_POWER)
+    {
+        apply_power_profile(false);
+    }
+}
+
+uint32_t WifiManager::get_radio_on_estimate(bool low_power)
+{
+    auto mode = get_power_save_mode(low_power);
+    uint32_t beacons = 1;
+
+    if (mode == WIFI_PS_NONE)
+    {
+        return 60000;
+    }
+    else if (mode == WIFI_PS_MAX_MODEM)
+    {
+        // 0 means driver default
+        beacons = listen_interval_ > 0 ? listen_interval_ : 3;
+    }
+
+    return 60000 * WIFI_BEACON_RX_MS / (WIFI_BEACON_INTERVAL_MS * beacons);
+}
@@ -1,13 +1,19 @@
 #pragma once
 #include <vector>
+#include <time.h>
 #include "system/configurable.h"
 #include "FreeRTOS.h"
+#include <freertos/semphr.h>
 #include "system/systemobject.h"
 #include "system/observable.h"
 #include "esp_wifi.h"
+#include "hardware/hardware.h"
 #define WIFI_AP_LIST_MAX_SIZE 32
 #define WIFI_RETRY_ARRAY_SIZE 8
 #define WIFI_RETRY_MAX_MINUTES 60.0
+#define WIFI_LISTEN_INTERVAL_DEFAULT 10 // beacons station sleeps in low power (announced to AP when associating)
+#define WIFI_BEACON_INTERVAL_MS 102     // usual AP beacon interval (100 TU)
+#define WIFI_BEACON_RX_MS 3             // radio on time of one wake-up for beacon (ramp up, beacon reception)
 
 enum WifiState_t
 {
@@ -17,10 +23,32 @@ enum WifiState_t
     Wifi_Connected
 };
 
+enum WifiConnectPath_t
+{
+    WIFI_PATH_FULL,    // scan of all channels and DHCP
+    WIFI_PATH_FAST,    // cached BSSID and channel, DHCP (lwIP asks for the last lease first, CONFIG_LWIP_DHCP_RESTORE_LAST_IP)
+    WIFI_PATH_FAST_IP, // cached BSSID and channel, static IP configured by user
+    WIFI_PATH_COUNT
+};
+
 struct KnownWifi_t
 {
     String known_ssid;
     String known_password;
+    uint8_t bssid[6] = {0}; // AP of last successful connection
+    uint8_t channel = 0;    // channel of last successful connection, 0 = unknown
+    bool static_ip = false; // ip, netmask, gateway and dns are configured by user, DHCP isn't used
+    uint32_t ip = 0;        // static configuration, network byte order
+    uint32_t netmask = 0;
+    uint32_t gateway = 0;
+    uint32_t dns = 0;
+};
+
+struct WifiConnectStats_t
+{
+    uint32_t count = 0;
+    uint32_t last_ms = 0;
+    uint64_t total_ms = 0;
 };
 
 class WifiManager : public Configurable, public SystemObject, public Observable<WifiState_t>
@@ -49,6 +77,19 @@ public:
     bool is_known_wifi(const String ssid);
     bool get_known_wifi_password(const String ssid, String &password);
     int get_wifi_rssi();
+    /// Returns time from enabling wifi to IP address of given connect path
+    const WifiConnectStats_t &get_connect_stats(WifiConnectPath_t path) { return connect_stats_[path]; }
+    uint32_t get_average_time_to_ip(WifiConnectPath_t path);
+    ///This is intended to be wired with Hardware class power events, it switches modem sleep profile
+    void handle_power_event(PowerCode_t code, uint32_t arg);
+    /**
+     * Modem sleep mode used in given watch power state. Listen interval applies only to WIFI_PS_MAX_MODEM,
+     * with WIFI_PS_MIN_MODEM station wakes up for every DTIM beacon.
+     * */
+    wifi_ps_type_t get_power_save_mode(bool low_power) { return low_power ? low_power_ps_mode_ : awake_ps_mode_; }
+    uint8_t get_listen_interval() { return listen_interval_; }
+    /// Estimated radio on time in ms per minute of idle connection with given profile (beacon reception only, DTIM 1)
+    uint32_t get_radio_on_estimate(bool low_power);
 private:
     void initialize();
     virtual void load_config_from_file(const JsonObject &json) override final;
@@ -64,9 +105,29 @@ private:
     static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                                    int32_t event_id, void *event_data);
     void clear_wifi_list();
+    SemaphoreHandle_t known_wifi_lock_; // known list is updated on event loop task and read by GUI, async and connect
     std::vector<KnownWifi_t> known_wifi_list_;
     static void wifi_reconnect_task(void *pvParameter);
     float wifi_retry_minutes_[WIFI_RETRY_ARRAY_SIZE] = {0.5, 1.0, 2.0, 3.0, 10.0, 20.0, 30.0, 60.0}; //{0.5, 1.0, 2.0, 3.0, 10.0, 20.0, 30.0, 60.0};
     int wifi_retry_counter_ = 0;
+    WifiConnectPath_t connect_path_ = WIFI_PATH_FULL;
+    int64_t connect_start_us_ = 0;
+    WifiConnectStats_t connect_stats_[WIFI_PATH_COUNT];
+    wifi_ps_type_t awake_ps_mode_ = WIFI_PS_MIN_MODEM;
+    wifi_ps_type_t low_power_ps_mode_ = WIFI_PS_MAX_MODEM;
+    uint8_t listen_interval_ = WIFI_LISTEN_INTERVAL_DEFAULT;
+    void apply_power_profile(bool low_power);
+    /// Caller holds known_wifi_lock_, the pointer is valid only until it's released
+    KnownWifi_t *find_known_wifi(const String &ssid);
+    /// Copies known wifi entry, returns false if the network isn't known
+    bool get_known_wifi(const String &ssid, KnownWifi_t &known);
+    WifiConnectPath_t select_connect_path(const KnownWifi_t *known);
+    /// Sets static IP or starts DHCP client according to selected connect path, called when STA interface starts
+    void apply_ip_config();
+    /// Adds current network to known wifi list and stores AP and channel of current connection
+    void update_connection_cache();
+    void record_time_to_ip();
+    /// Forgets cached AP of current network and starts full connect
+    void fallback_to_full_connect();
 
 };
\ No newline at end of file
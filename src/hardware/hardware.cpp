@@ -1,5 +1,6 @@
 #include "hardware.h"
 #include "system/events.h"
+#include "esp_timer.h"
 
 EventGroupHandle_t isr_group = NULL;
 volatile bool vibrate_task_running = false;
@@ -9,12 +10,21 @@ volatile bool vibrate_task_running = false;
 #define WATCH_FLAG_BMA_IRQ _BV(3)    // leaving sleep mode because of double tap or tilt
 #define WATCH_FLAG_AXP_IRQ _BV(4)    // leaving sleep mode because of external button press or any other power management interrupt
 #define WATCH_FLAG_TOUCH_IRQ _BV(5)  // leaving sleep mode because of touch (not yet implemented)
+#define WATCH_FLAG_APP_WAKE _BV(6)   // leaving sleep mode because application wants to show something (see wakeup_from_task)
 
 #define MOTOR_CHANNEL 1
 #define MOTOR_FREQUENCY 12000
 
 const char *HW_TAG = "HW";
 
+void wakeup_from_task()
+{
+    if (isr_group != NULL)
+    {
+        xEventGroupSetBits(isr_group, WATCH_FLAG_APP_WAKE);
+    }
+}
+
 Hardware::Hardware() : Configurable("/config/hardware")
 {
     load();
@@ -174,27 +184,46 @@ void Hardware::low_energy()
         lenergy_ = true;
 
         ESP_LOGI(HW_TAG, "Entering light sleep.");
-        uint counter = 0;
-        while (!(isr_bits & WATCH_FLAG_SLEEP_EXIT) && !(app_bits & G_APP_STATE_WAKE_UP))
+        auto sleep_start = esp_timer_get_time();
+        uint32_t wakeups = 0;
+        isr_bits = xEventGroupGetBits(isr_group);
+        app_bits = xEventGroupGetBits(g_app_state);
+        low_power_jobs_.start(sleep_start);
+
+        // task blocks until interrupt, wake up request or deadline of the next low power job, so CPU can stay in light sleep
+        while (!(isr_bits & (WATCH_FLAG_SLEEP_EXIT | WATCH_FLAG_APP_WAKE)) && !(app_bits & G_APP_STATE_WAKE_UP))
         {
-            delay(500);
-            counter++;
-            isr_bits = xEventGroupGetBits(isr_group);
+            auto deadline = low_power_jobs_.get_next_deadline();
+            auto now = esp_timer_get_time();
+            TickType_t timeout = portMAX_DELAY;
+
+            if (deadline != LOW_POWER_NO_DEADLINE)
+            {
+                // rounded up, so the deadline has passed when the task wakes up
+                timeout = deadline > now ? ((deadline - now) / 1000 + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS : 0;
+            }
+
+            isr_bits = xEventGroupWaitBits(isr_group, WATCH_FLAG_SLEEP_EXIT | WATCH_FLAG_APP_WAKE, pdFALSE, pdFALSE, timeout);
             app_bits = xEventGroupGetBits(g_app_state);
-            //Signal every 5000 ms low power actions
-            if (counter % 10 == 0)
+            wakeups++;
+
+            if (!(isr_bits & (WATCH_FLAG_SLEEP_EXIT | WATCH_FLAG_APP_WAKE)) && !(app_bits & G_APP_STATE_WAKE_UP))
             {
-                invoke_power_callbacks(PowerCode_t::POWER_LOW_TICK, counter / 2);
+                low_power_jobs_.run_due(esp_timer_get_time());
             }
         }
 
+        sleep_wakeups_ += wakeups;
         xEventGroupClearBits(g_app_state, G_APP_STATE_WAKE_UP);
-        if (app_bits & G_APP_STATE_WAKE_UP)
+        if ((app_bits & G_APP_STATE_WAKE_UP) || (isr_bits & WATCH_FLAG_APP_WAKE))
         {
+            xEventGroupClearBits(isr_group, WATCH_FLAG_APP_WAKE);
             xEventGroupSetBits(isr_group, WATCH_FLAG_SLEEP_EXIT);
         }
 
-        ESP_LOGI(HW_TAG, "Wakeup request from sleep. System isr=%d,app=%d", isr_bits, app_bits);
+        ESP_LOGI(HW_TAG, "Wakeup request from sleep after %d s with %u wakeups. System isr=%d,app=%d",
+                 (int)((esp_timer_get_time() - sleep_start) / 1000000), wakeups, isr_bits, app_bits);
+        low_power_jobs_.log_stats();
         //}
     }
     else // watch is in low power mode, so wake it up now
@@ -7,6 +7,7 @@
 #include "system/async_dispatcher.h"
 #include "sounds/sound_player.h"
 #include "hardware/touch.h"
+#include "system/low_power_scheduler.h"
 
 enum PowerCode_t
 {
@@ -16,7 +17,6 @@ enum PowerCode_t
     POWER_CHARGING_OFF,
     POWER_CHARGING_DONE,
     WALK_STEP_COUNTER_UPDATED,
-    POWER_LOW_TICK,
     DOUBLE_TAP_DETECTED
 };
 
@@ -28,6 +28,8 @@ enum WakeupSource_t
 };
 
 extern void IRAM_ATTR wakeup_from_isr();
+/// Wakes the watch from low power sleep loop (from any task)
+void wakeup_from_task();
 
 typedef std::function<void(PowerCode_t, uint32_t)> low_power_callback;
 /**
@@ -91,6 +93,10 @@ public:
     {
         return player_;
     }
+    ///Jobs executed while the watch sleeps in low power mode
+    LowPowerScheduler &get_low_power_scheduler() { return low_power_jobs_; }
+    ///Returns how many times sleep loop woke up the CPU (all low power periods since boot)
+    uint32_t get_sleep_wakeup_count() { return sleep_wakeups_; }
 private:
     std::vector<low_power_callback> power_callbacks_;
     std::function<uint32_t(void)> get_screen_timeout_;
@@ -100,6 +106,8 @@ private:
     TTGOClass *watch_;
     bool lenergy_ = false;
     bool is_vibrating_ = false;
+    uint32_t sleep_wakeups_ = 0;
+    LowPowerScheduler low_power_jobs_;
     void low_energy();
     void invoke_power_callbacks(PowerCode_t code, uint32_t arg);
     void update_bma_wakeup();
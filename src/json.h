@@ -1,12 +1,13 @@
 #pragma once
 #include <ArduinoJson.h>
+#include "system/psram.h"
 //allocate all JSON strings in SPI RAM
 struct SpiRamAllocator {
   void* allocate(size_t size) {
-    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    return twatchsk::psram_malloc(size);
   }
   void deallocate(void* pointer) {
-    heap_caps_free(pointer);
+    twatchsk::psram_free(pointer);
   }
 };
 
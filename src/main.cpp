@@ -163,8 +163,11 @@ void setup()
     sk_socket = new SignalKSocket(wifiManager);
     sk_socket->add_subscription("notifications.*", 1000, true);
     sk_socket->add_subscription("environment.mode", 5000, false);
+    //Switch wifi modem sleep profile with watch power state
+    hardware->attach_power_callback(std::bind(&WifiManager::handle_power_event, wifiManager, _1, _2));
     //Attach power management events to sk_socket
     hardware->attach_power_callback(std::bind(&SignalKSocket::handle_power_event, sk_socket, _1, _2));
+    sk_socket->register_low_power_jobs(hardware->get_low_power_scheduler());
     set_splash_screen_status(ttgo, 60);
     //Intialize watch GUI
     gui = new Gui();
@@ -172,6 +175,8 @@ void setup()
     gui->setup_gui(wifiManager, sk_socket, hardware);
     //set SK socket pointer to device name in gui
     sk_socket->set_device_name(gui->get_watch_name());
+    //Replay recorded SignalK session if it's enabled in websocket config (benchmark of value pipeline)
+    sk_socket->start_replay();
     //Clear lvgl counter
     lv_disp_trig_activity(NULL);
     //When the initialization is complete, turn on the backlight
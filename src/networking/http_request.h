@@ -20,63 +20,83 @@ public:
         auto file = SPIFFS.open(path, "w");
         if (file)
         {
-            ESP_LOGI("HTTP", "HTTP GET intializing client...");
-            esp_http_client_config_t config = {
-                .url = requestUrl_,
-                .event_handler = _http_event_handle};
+            ret = get([&file](const char *data, int len) -> bool
+                      {
+                          file.write((const uint8_t *)data, (size_t)len);
+                          return true;
+                      });
 
-            esp_http_client_handle_t client = esp_http_client_init(&config);
-            //set method
-            esp_http_client_set_method(client, esp_http_client_method_t::HTTP_METHOD_GET);
-            //set auth header
-            char buffer[512];
-            sprintf(buffer, "Bearer %s", token_);
-            esp_http_client_set_header(client, "Authorization", buffer);
-            ESP_LOGI("HTTP", "HTTP GET  opening connection to %s...", requestUrl_);
-            esp_err_t err = esp_http_client_open(client, 0);
-            ESP_LOGI("HTTP", "HTTP GET open connection result=%d.", err);
-            if (err == ESP_OK)
-            {
-                auto len = esp_http_client_fetch_headers(client);
-                auto status = esp_http_client_get_status_code(client);
-                ESP_LOGI("HTTP", "HTTP GET %s got status %d with len %d", requestUrl_, status, len);
+            file.close();
+            ESP_LOGI("HTTP", "File closed!");
+        }
+        else
+        {
+            ESP_LOGI("HTTP", "Unable to create file!");
+        }
+
+        return ret;
+    }
+
+    /**
+     * @brief Sends HTTP GET and streams response body in chunks to on_data callback (callback can return false to abort)
+     * @return true if status was 200 and whole body has been received
+     **/
+    bool get(std::function<bool(const char *, int)> on_data)
+    {
+        auto ret = false;
+        ESP_LOGI("HTTP", "HTTP GET intializing client...");
+        esp_http_client_config_t config = {
+            .url = requestUrl_,
+            .event_handler = _http_event_handle};
+
+        esp_http_client_handle_t client = esp_http_client_init(&config);
+        //set method
+        esp_http_client_set_method(client, esp_http_client_method_t::HTTP_METHOD_GET);
+        //set auth header
+        char buffer[512];
+        sprintf(buffer, "Bearer %s", token_);
+        esp_http_client_set_header(client, "Authorization", buffer);
+        ESP_LOGI("HTTP", "HTTP GET  opening connection to %s...", requestUrl_);
+        esp_err_t err = esp_http_client_open(client, 0);
+        ESP_LOGI("HTTP", "HTTP GET open connection result=%d.", err);
+        if (err == ESP_OK)
+        {
+            auto len = esp_http_client_fetch_headers(client);
+            auto status = esp_http_client_get_status_code(client);
+            ESP_LOGI("HTTP", "HTTP GET %s got status %d with len %d", requestUrl_, status, len);
 
-                if (status == 200)
+            if (status == 200)
+            {
+                int total = 0;
+                int readLen = -1;
+                bool aborted = false;
+                while (readLen != 0 && !aborted)
                 {
-                    int total = 0;
-                    int readLen = -1;
-                    while (readLen != 0)
+                    readLen = esp_http_client_read(client, buffer, sizeof(buffer));
+                    ESP_LOGD("HTTP", "HTTP GET read=%d", readLen);
+
+                    if (readLen > 0)
                     {
-                        readLen = esp_http_client_read(client, buffer, sizeof(buffer));
-                        ESP_LOGI("HTTP", "HTTP GET read=%d", readLen);
                         total += readLen;
-
-                        if (readLen > 0)
-                        {
-                            file.write((const uint8_t *)buffer, (size_t)readLen);
-                        }
+                        aborted = !on_data(buffer, readLen);
                     }
-                    if(total == len)
+                    else if (readLen < 0)
                     {
-                        ret = true;
+                        break;
                     }
-
-                    ESP_LOGI("HTTP", "HTTP GET DONE!");
+                }
+                if (!aborted && (total == len || (len <= 0 && readLen == 0)))
+                {
+                    ret = true;
                 }
 
-                esp_http_client_cleanup(client);
-
-                ESP_LOGI("HTTP", "Client cleanup.");
+                ESP_LOGI("HTTP", "HTTP GET DONE (%d bytes)!", total);
             }
-
-            file.close();
-            ESP_LOGI("HTTP", "File closed!");
-        }
-        else
-        {
-            ESP_LOGI("HTTP", "Unable to create file!");
         }
 
+        esp_http_client_cleanup(client);
+        ESP_LOGI("HTTP", "Client cleanup.");
+
         return ret;
     }
 
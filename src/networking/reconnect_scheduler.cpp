@@ -0,0 +1,259 @@
+#include "reconnect_scheduler.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+static const char *RECONNECT_TAG = "RECONNECT";
+
+ReconnectScheduler::ReconnectScheduler()
+{
+    lock_ = xSemaphoreCreateMutex();
+    // list never grows over the limit, so entries are never moved
+    servers_.reserve(SK_KNOWN_SERVERS_MAX);
+}
+
+void ReconnectScheduler::set_primary(const String &host, int port)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (servers_.empty())
+    {
+        servers_.push_back(ReconnectServer_t());
+    }
+
+    auto &primary = servers_[0];
+    if (primary.host != host || primary.port != port)
+    {
+        primary.host = host;
+        primary.port = port;
+        primary.last_ip = "";
+        primary.token = "";
+    }
+    xSemaphoreGive(lock_);
+}
+
+bool ReconnectScheduler::add_server(const String &host, int port, const String &last_ip, const String &token)
+{
+    bool ret = false;
+
+    if (host.isEmpty() || port <= 0)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (servers_.size() < SK_KNOWN_SERVERS_MAX)
+    {
+        ret = true;
+        for (auto &server : servers_)
+        {
+            if (server.host == host && server.port == port)
+            {
+                ret = false;
+                break;
+            }
+        }
+
+        if (ret)
+        {
+            ReconnectServer_t server;
+            server.host = host;
+            server.port = port;
+            server.last_ip = last_ip;
+            server.token = token;
+            servers_.push_back(server);
+        }
+    }
+    xSemaphoreGive(lock_);
+
+    if (ret)
+    {
+        ESP_LOGI(RECONNECT_TAG, "Added known server %s:%d", host.c_str(), port);
+    }
+
+    return ret;
+}
+
+ReconnectServer_t ReconnectScheduler::get_server(int server)
+{
+    ReconnectServer_t ret;
+    ret.port = 0;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (server >= 0 && server < (int)servers_.size())
+    {
+        ret = servers_[server];
+    }
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+std::vector<ReconnectServer_t> ReconnectScheduler::get_servers()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    std::vector<ReconnectServer_t> ret = servers_;
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+bool ReconnectScheduler::set_last_ip(int server, const String &ip)
+{
+    bool ret = false;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (server >= 0 && server < (int)servers_.size() && servers_[server].last_ip != ip)
+    {
+        servers_[server].last_ip = ip;
+        ret = true;
+    }
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+String ReconnectScheduler::get_token(int server)
+{
+    return get_server(server).token;
+}
+
+void ReconnectScheduler::set_token(int server, const String &token)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (server >= 0 && server < (int)servers_.size())
+    {
+        servers_[server].token = token;
+    }
+    xSemaphoreGive(lock_);
+}
+
+void ReconnectScheduler::clear_tokens()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (auto &server : servers_)
+    {
+        server.token = "";
+    }
+    xSemaphoreGive(lock_);
+}
+
+uint32_t ReconnectScheduler::on_disconnected(bool low_power)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (disconnected_us_ == 0)
+    {
+        disconnected_us_ = esp_timer_get_time();
+        attempt_ = 0;
+        // start with the server that was connected
+        target_server_ = connected_server_;
+    }
+    int attempt = attempt_;
+    xSemaphoreGive(lock_);
+
+    uint32_t cap = low_power ? SK_RECONNECT_MAX_DELAY_LOW_POWER : SK_RECONNECT_MAX_DELAY;
+    uint32_t delay = SK_RECONNECT_BASE_DELAY;
+
+    for (int i = 0; i < attempt && delay < cap; i++)
+    {
+        delay *= 2;
+    }
+
+    if (delay > cap)
+    {
+        delay = cap;
+    }
+
+    // half of the delay is fixed, the other half is random (equal jitter)
+    return delay / 2 + esp_random() % (delay / 2 + 1);
+}
+
+ReconnectTarget_t ReconnectScheduler::next_target()
+{
+    ReconnectTarget_t ret;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    if (servers_.empty())
+    {
+        xSemaphoreGive(lock_);
+        ret.port = 0;
+        ret.server = -1;
+        ret.cached_ip = false;
+        return ret;
+    }
+
+    int server_count = servers_.size();
+    int index = (target_server_ + attempt_ / SK_RECONNECT_ATTEMPTS_PER_SERVER) % server_count;
+    auto server = servers_[index];
+    // first attempt of every server goes to cached IP, next ones resolve the name again (IP could have changed)
+    ret.cached_ip = attempt_ % SK_RECONNECT_ATTEMPTS_PER_SERVER == 0 && !server.last_ip.isEmpty();
+    attempt_++;
+    attempt_count_++;
+    int attempt = attempt_;
+    xSemaphoreGive(lock_);
+
+    ret.address = ret.cached_ip ? server.last_ip : server.host;
+    ret.port = server.port;
+    ret.server = index;
+
+    ESP_LOGI(RECONNECT_TAG, "Reconnect attempt %d to %s:%d (server %d)", attempt, ret.address.c_str(), ret.port, index);
+
+    return ret;
+}
+
+void ReconnectScheduler::on_connected(int server)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    connected_server_ = server;
+    bool reconnected = disconnected_us_ != 0;
+    int attempts = attempt_;
+
+    if (reconnected)
+    {
+        last_reconnect_ms_ = (uint32_t)((esp_timer_get_time() - disconnected_us_) / 1000);
+        reconnect_count_++;
+    }
+
+    disconnected_us_ = 0;
+    attempt_ = 0;
+    xSemaphoreGive(lock_);
+
+    if (reconnected)
+    {
+        ESP_LOGI(RECONNECT_TAG, "Reconnected after %d attempts in %u ms", attempts, last_reconnect_ms_);
+    }
+}
+
+void ReconnectScheduler::reset()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    disconnected_us_ = 0;
+    attempt_ = 0;
+    xSemaphoreGive(lock_);
+}
+
+bool ReconnectScheduler::is_reconnecting()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    bool ret = disconnected_us_ != 0;
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+int ReconnectScheduler::get_current_attempt()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    int ret = attempt_;
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+int ReconnectScheduler::get_connected_server()
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    int ret = connected_server_;
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "Arduino.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define SK_RECONNECT_BASE_DELAY 1000         // ms before first reconnect attempt
+#define SK_RECONNECT_MAX_DELAY 30000         // ms cap of backoff when watch is in use
+#define SK_RECONNECT_MAX_DELAY_LOW_POWER 300000 // ms cap of backoff in low power mode
+#define SK_RECONNECT_ATTEMPTS_PER_SERVER 2   // attempts (cached IP + host name) before failing over to next server
+#define SK_KNOWN_SERVERS_MAX 4
+
+struct ReconnectServer_t
+{
+    String host;
+    int port;
+    String last_ip; // resolved address of host from last successful connection (empty if unknown)
+    String token;   // access token issued by this server (empty if the watch has no access yet)
+};
+
+struct ReconnectTarget_t
+{
+    String address; // IP address (fast path) or host name
+    int port;
+    int server;     // index of server in the list
+    bool cached_ip;
+};
+
+/**
+ * @brief Decides when and where to reconnect after connection to SignalK server is lost.
+ * Delays grow exponentially, half of every delay is random (so several watches don't reconnect at the same moment)
+ * and they are capped by power mode. Every server from the list gets SK_RECONNECT_ATTEMPTS_PER_SERVER attempts, first one goes to the
+ * last resolved IP so DNS / mDNS lookup is skipped, then it fails over to the next server.
+ * Server list and backoff state are shared by websocket, async dispatcher, Wifi event and mDNS tasks, so they are
+ * guarded by a lock and only copies of entries are handed out.
+ **/
+class ReconnectScheduler
+{
+public:
+    ReconnectScheduler();
+    /// Sets primary server (configured by user), it's always the first one in the list. Cached IP and token
+    /// are forgotten when the address changes.
+    void set_primary(const String &host, int port);
+    /// Adds alternative server (from config or mDNS discovery), returns false if it's known already or list is full
+    bool add_server(const String &host, int port, const String &last_ip = "", const String &token = "");
+    /// Returns copy of server entry (entry with empty host if index is out of range)
+    ReconnectServer_t get_server(int server);
+    /// Returns copy of the whole list
+    std::vector<ReconnectServer_t> get_servers();
+    /// Remembers resolved IP of the server, so the next reconnect can skip name resolution, returns true if it changed
+    bool set_last_ip(int server, const String &ip);
+    /// Returns access token issued by the server
+    String get_token(int server);
+    /// Stores access token issued by the server (it's never sent to other servers)
+    void set_token(int server, const String &token);
+    /// Forgets tokens of all servers
+    void clear_tokens();
+    /// Called when connection is lost, returns delay in ms before next attempt
+    uint32_t on_disconnected(bool low_power);
+    /// Returns address of next attempt and counts it
+    ReconnectTarget_t next_target();
+    /// Called when connection to the server (index in the list) is established, records time to reconnect and resets backoff
+    void on_connected(int server);
+    /// Cancels pending reconnection (user disconnected, Wifi is off)
+    void reset();
+    bool is_reconnecting();
+    int get_current_attempt();
+    int get_connected_server();
+    uint32_t get_attempt_count() { return attempt_count_; }
+    uint32_t get_reconnect_count() { return reconnect_count_; }
+    uint32_t get_last_reconnect_time() { return last_reconnect_ms_; }
+
+private:
+    std::vector<ReconnectServer_t> servers_;
+    SemaphoreHandle_t lock_;
+    int attempt_ = 0;
+    int target_server_ = 0;
+    int connected_server_ = 0;
+    int64_t disconnected_us_ = 0;
+    uint32_t attempt_count_ = 0;
+    uint32_t reconnect_count_ = 0;
+    uint32_t last_reconnect_ms_ = 0;
+};
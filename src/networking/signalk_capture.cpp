@@ -0,0 +1,226 @@
+#include "signalk_capture.h"
+#include "ws_frame_assembler.h"
+#include "system/psram.h"
+#include "system/pipeline_stats.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+static const char *CAPTURE_TAG = "CAPTURE";
+
+struct ReplayContext_t
+{
+    String path;
+    ReplayMode_t mode;
+    capture_replay_callback parse;
+};
+
+std::atomic<bool> SignalKCapture::replaying_(false);
+
+bool SignalKCapture::start(const char *path)
+{
+    if (recording_ || writer_running_ || replaying_)
+    {
+        return false;
+    }
+
+    if (queue_ == NULL)
+    {
+        queue_ = xQueueCreate(SK_CAPTURE_QUEUE_LENGTH, sizeof(uint8_t *));
+        if (queue_ == NULL)
+        {
+            return false;
+        }
+    }
+
+    file_ = SPIFFS.open(path, "w");
+    if (!file_)
+    {
+        ESP_LOGW(CAPTURE_TAG, "Unable to create capture file %s!", path);
+        return false;
+    }
+
+    size_ = 0;
+    dropped_ = 0;
+    start_time_ = millis();
+    recording_ = true;
+    writer_running_ = true;
+
+    if (xTaskCreate(writer_task, "sk_capture", 3072, this, 2, NULL) != pdPASS)
+    {
+        recording_ = false;
+        writer_running_ = false;
+        file_.close();
+        return false;
+    }
+
+    ESP_LOGI(CAPTURE_TAG, "Recording websocket messages into %s...", path);
+
+    return true;
+}
+
+void SignalKCapture::record(const char *data, int length)
+{
+    if (!recording_)
+    {
+        return;
+    }
+
+    if (size_ + sizeof(CaptureRecord_t) + length > SK_CAPTURE_MAX_SIZE)
+    {
+        ESP_LOGI(CAPTURE_TAG, "Capture file is full.");
+        stop();
+        return;
+    }
+
+    auto block = (uint8_t *)twatchsk::psram_malloc(sizeof(CaptureRecord_t) + length);
+    if (block == NULL)
+    {
+        dropped_++;
+        return;
+    }
+
+    auto header = (CaptureRecord_t *)block;
+    header->time_ms = millis() - start_time_;
+    header->length = length;
+    memcpy(block + sizeof(CaptureRecord_t), data, length);
+
+    // SPIFFS write can take tens of ms (page erase), so websocket task only queues the copy
+    if (xQueueSend(queue_, &block, 0) != pdTRUE)
+    {
+        twatchsk::psram_free(block);
+        dropped_++;
+        return;
+    }
+
+    size_ += sizeof(CaptureRecord_t) + length;
+}
+
+void SignalKCapture::stop()
+{
+    if (recording_)
+    {
+        recording_ = false;
+        ESP_LOGI(CAPTURE_TAG, "Recording stopped, captured %d bytes, %d messages dropped.", size_, dropped_);
+    }
+}
+
+void SignalKCapture::writer_task(void *arg)
+{
+    auto capture = (SignalKCapture *)arg;
+    uint8_t *block = NULL;
+
+    while (true)
+    {
+        if (xQueueReceive(capture->queue_, &block, 100 / portTICK_PERIOD_MS) == pdTRUE)
+        {
+            auto header = (CaptureRecord_t *)block;
+            capture->file_.write(block, sizeof(CaptureRecord_t) + header->length);
+            twatchsk::psram_free(block);
+        }
+        else if (!capture->recording_)
+        {
+            // records queued just before stop() are written as well
+            if (uxQueueMessagesWaiting(capture->queue_) == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    capture->file_.close();
+    ESP_LOGI(CAPTURE_TAG, "Capture file closed.");
+    capture->writer_running_ = false;
+    vTaskDelete(NULL);
+}
+
+bool SignalKCapture::replay(const char *path, ReplayMode_t mode, capture_replay_callback parse)
+{
+    if (replaying_ || mode == REPLAY_OFF || !SPIFFS.exists(path))
+    {
+        return false;
+    }
+
+    auto context = new ReplayContext_t();
+    context->path = path;
+    context->mode = mode;
+    context->parse = parse;
+    replaying_ = true;
+
+    // replay can take minutes in real time mode, so it doesn't block async dispatcher
+    if (xTaskCreate(replay_task, "sk_replay", CONFIG_MAIN_TASK_STACK_SIZE, context, 5, NULL) != pdPASS)
+    {
+        delete context;
+        replaying_ = false;
+        return false;
+    }
+
+    return true;
+}
+
+void SignalKCapture::replay_task(void *arg)
+{
+    auto context = (ReplayContext_t *)arg;
+    auto file = SPIFFS.open(context->path);
+    auto buffer = (char *)twatchsk::psram_malloc(WS_MAX_MESSAGE_SIZE);
+    uint32_t messages = 0;
+    uint32_t bytes = 0;
+
+    if (file && buffer != NULL)
+    {
+        ESP_LOGI(CAPTURE_TAG, "Replaying %s (mode=%d)...", context->path.c_str(), (int)context->mode);
+        pipeline_stats_reset();
+        auto start = esp_timer_get_time();
+        CaptureRecord_t header;
+
+        while (file.read((uint8_t *)&header, sizeof(header)) == sizeof(header))
+        {
+            if (header.length > WS_MAX_MESSAGE_SIZE || file.read((uint8_t *)buffer, header.length) != header.length)
+            {
+                ESP_LOGW(CAPTURE_TAG, "Capture file is corrupted after %d messages!", messages);
+                break;
+            }
+
+            if (context->mode == REPLAY_REAL_TIME)
+            {
+                int64_t wait_ms = header.time_ms - (esp_timer_get_time() - start) / 1000;
+                if (wait_ms > 0)
+                {
+                    vTaskDelay(wait_ms / portTICK_PERIOD_MS);
+                }
+            }
+
+            context->parse(header.length, buffer);
+            messages++;
+            bytes += header.length;
+        }
+
+        uint32_t elapsed_ms = (esp_timer_get_time() - start) / 1000;
+        // let GUI task render what's left in value slots
+        vTaskDelay(500 / portTICK_PERIOD_MS);
+
+        ESP_LOGI(CAPTURE_TAG, "Replayed %u messages (%u bytes) in %u ms, %u deltas/s", messages, bytes, elapsed_ms,
+                 elapsed_ms > 0 ? (uint32_t)((uint64_t)messages * 1000 / elapsed_ms) : messages);
+        pipeline_stats_log("Replay finished");
+    }
+    else
+    {
+        ESP_LOGW(CAPTURE_TAG, "Unable to open capture file %s!", context->path.c_str());
+    }
+
+    if (file)
+    {
+        file.close();
+    }
+
+    if (buffer != NULL)
+    {
+        twatchsk::psram_free(buffer);
+    }
+
+    delete context;
+    replaying_ = false;
+    vTaskDelete(NULL);
+}
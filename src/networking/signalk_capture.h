@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "SPIFFS.h"
+
+#define SK_CAPTURE_FILE "/sk_capture.bin"
+#define SK_CAPTURE_MAX_SIZE 524288 // recording stops when capture file reaches this size
+#define SK_CAPTURE_QUEUE_LENGTH 32 // records waiting for writer task, more are dropped
+
+enum ReplayMode_t
+{
+    REPLAY_OFF = 0,
+    REPLAY_REAL_TIME = 1, // messages are replayed with the same timing as they were recorded
+    REPLAY_FAST = 2       // messages are replayed as fast as possible
+};
+
+/// Capture file is sequence of records, every header is followed by length bytes of websocket message
+struct CaptureRecord_t
+{
+    uint32_t time_ms; // time since start of recording
+    uint32_t length;
+};
+
+typedef std::function<void(int, const char *)> capture_replay_callback;
+
+/**
+ * @brief Records complete websocket messages received from SignalK server into SPIFFS file and replays them
+ * back into message parser, so ingest pipeline (parse -> GUI value slots -> components) can be benchmarked
+ * with real data without server. Latencies are reported by pipeline stats when replay is finished.
+ * Records are copied and written by separate writer task, so SPIFFS writes (and erases) don't stall websocket task.
+ **/
+class SignalKCapture
+{
+public:
+    /// Starts recording, it fails while the writer is still flushing previous recording
+    bool start(const char *path = SK_CAPTURE_FILE);
+    /// Queues copy of message for writer task, it's called from websocket task and never blocks
+    void record(const char *data, int length);
+    /// Stops recording, writer task writes what's queued and closes the file
+    void stop();
+    bool is_recording() { return recording_; }
+    static bool is_replaying() { return replaying_; }
+    /// Starts replay of capture file in separate task, every message is passed to parse callback
+    static bool replay(const char *path, ReplayMode_t mode, capture_replay_callback parse);
+
+private:
+    File file_;
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> writer_running_{false};
+    QueueHandle_t queue_ = NULL; // pointers to header + data blocks, created once
+    uint32_t size_ = 0;
+    uint32_t dropped_ = 0;
+    unsigned long start_time_ = 0;
+    static std::atomic<bool> replaying_;
+    static void writer_task(void *arg);
+    static void replay_task(void *arg);
+};
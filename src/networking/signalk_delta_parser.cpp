@@ -0,0 +1,293 @@
+#include "signalk_delta_parser.h"
+#include <string.h>
+
+SignalKDeltaParser::SignalKDeltaParser(const char *data, int length)
+{
+    data_ = data;
+    end_ = data + length;
+    pos_ = data;
+}
+
+bool SignalKDeltaParser::parse(delta_value_callback callback)
+{
+    pos_ = data_;
+    has_updates_ = false;
+    value_count_ = 0;
+
+    return walk_object([this, &callback](const char *key, int key_len) -> bool
+                       {
+                           if (key_equals(key, key_len, "updates"))
+                           {
+                               has_updates_ = true;
+                               return parse_updates(callback);
+                           }
+
+                           return skip_value(NULL, NULL);
+                       });
+}
+
+void SignalKDeltaParser::skip_whitespace()
+{
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\r' || *pos_ == '\n'))
+    {
+        pos_++;
+    }
+}
+
+bool SignalKDeltaParser::consume(char c)
+{
+    skip_whitespace();
+
+    if (pos_ < end_ && *pos_ == c)
+    {
+        pos_++;
+        return true;
+    }
+
+    return false;
+}
+
+/// Reads JSON string and returns slice without quotes, escape sequences are kept as they are
+bool SignalKDeltaParser::read_string(const char *&str, int &len)
+{
+    if (!consume('"'))
+    {
+        return false;
+    }
+
+    str = pos_;
+
+    while (pos_ < end_)
+    {
+        if (*pos_ == '\\')
+        {
+            pos_ += 2;
+        }
+        else if (*pos_ == '"')
+        {
+            len = pos_ - str;
+            pos_++;
+            return true;
+        }
+        else
+        {
+            pos_++;
+        }
+    }
+
+    return false;
+}
+
+/// Skips any JSON value, if start and len are set they will receive raw JSON text of the value
+bool SignalKDeltaParser::skip_value(const char **start, int *len)
+{
+    skip_whitespace();
+
+    if (pos_ >= end_)
+    {
+        return false;
+    }
+
+    const char *value_start = pos_;
+
+    if (*pos_ == '"')
+    {
+        const char *str;
+        int str_len;
+        if (!read_string(str, str_len))
+        {
+            return false;
+        }
+    }
+    else if (*pos_ == '{' || *pos_ == '[')
+    {
+        int depth = 0;
+
+        while (pos_ < end_)
+        {
+            char c = *pos_;
+            if (c == '"')
+            {
+                const char *str;
+                int str_len;
+                if (!read_string(str, str_len))
+                {
+                    return false;
+                }
+                continue;
+            }
+            else if (c == '{' || c == '[')
+            {
+                depth++;
+            }
+            else if (c == '}' || c == ']')
+            {
+                depth--;
+                if (depth == 0)
+                {
+                    pos_++;
+                    break;
+                }
+            }
+            pos_++;
+        }
+
+        if (depth != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // number, true, false or null
+        while (pos_ < end_ && *pos_ != ',' && *pos_ != '}' && *pos_ != ']' &&
+               *pos_ != ' ' && *pos_ != '\t' && *pos_ != '\r' && *pos_ != '\n')
+        {
+            pos_++;
+        }
+
+        if (pos_ == value_start)
+        {
+            return false;
+        }
+    }
+
+    if (start != NULL && len != NULL)
+    {
+        *start = value_start;
+        *len = pos_ - value_start;
+    }
+
+    return true;
+}
+
+/// Walks JSON object, member is called for every key with position set to the beginning of its value and it has to consume the value
+template <typename F>
+bool SignalKDeltaParser::walk_object(F member)
+{
+    if (!consume('{'))
+    {
+        return false;
+    }
+
+    if (consume('}'))
+    {
+        return true;
+    }
+
+    while (true)
+    {
+        const char *key;
+        int key_len;
+
+        if (!read_string(key, key_len) || !consume(':') || !member(key, key_len))
+        {
+            return false;
+        }
+
+        if (consume(','))
+        {
+            continue;
+        }
+
+        return consume('}');
+    }
+}
+
+/// Walks JSON array, element is called with position set to the beginning of every item and it has to consume the item
+template <typename F>
+bool SignalKDeltaParser::walk_array(F element)
+{
+    if (!consume('['))
+    {
+        return false;
+    }
+
+    if (consume(']'))
+    {
+        return true;
+    }
+
+    while (true)
+    {
+        skip_whitespace();
+
+        if (!element())
+        {
+            return false;
+        }
+
+        if (consume(','))
+        {
+            continue;
+        }
+
+        return consume(']');
+    }
+}
+
+bool SignalKDeltaParser::parse_updates(delta_value_callback &callback)
+{
+    return walk_array([this, &callback]() -> bool
+                      {
+                          if (pos_ < end_ && *pos_ == '{')
+                          {
+                              return walk_object([this, &callback](const char *key, int key_len) -> bool
+                                                 {
+                                                     if (key_equals(key, key_len, "values"))
+                                                     {
+                                                         return parse_values(callback);
+                                                     }
+
+                                                     return skip_value(NULL, NULL);
+                                                 });
+                          }
+
+                          return skip_value(NULL, NULL);
+                      });
+}
+
+bool SignalKDeltaParser::parse_values(delta_value_callback &callback)
+{
+    return walk_array([this, &callback]() -> bool
+                      {
+                          if (pos_ < end_ && *pos_ == '{')
+                          {
+                              return parse_value(callback);
+                          }
+
+                          return skip_value(NULL, NULL);
+                      });
+}
+
+bool SignalKDeltaParser::parse_value(delta_value_callback &callback)
+{
+    SignalKDeltaValue_t value = {NULL, 0, NULL, 0};
+
+    auto ret = walk_object([this, &value](const char *key, int key_len) -> bool
+                           {
+                               if (key_equals(key, key_len, "path"))
+                               {
+                                   return read_string(value.path, value.path_len);
+                               }
+                               else if (key_equals(key, key_len, "value"))
+                               {
+                                   return skip_value(&value.value, &value.value_len);
+                               }
+
+                               return skip_value(NULL, NULL);
+                           });
+
+    if (ret && value.path != NULL && value.value != NULL)
+    {
+        value_count_++;
+        callback(value);
+    }
+
+    return ret;
+}
+
+bool SignalKDeltaParser::key_equals(const char *key, int key_len, const char *literal)
+{
+    return strncmp(key, literal, key_len) == 0 && literal[key_len] == '\0';
+}
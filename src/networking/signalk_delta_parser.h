@@ -0,0 +1,55 @@
+#pragma once
+#include <stddef.h>
+#include <functional>
+
+/**
+ * @brief Single value found in SignalK delta message. Both slices are pointing into received websocket buffer,
+ * path is without quotes and value is raw JSON text (number, "string", object, true/false/null).
+ **/
+struct SignalKDeltaValue_t
+{
+    const char *path;
+    int path_len;
+    const char *value;
+    int value_len;
+};
+
+typedef std::function<void(const SignalKDeltaValue_t &)> delta_value_callback;
+
+/**
+ * @brief Streaming (SAX style) parser of SignalK delta messages. It walks updates[].values[] in place over received buffer
+ * and hands out path/value slices without building JSON document, copying strings or allocating heap memory.
+ * Messages without "updates" member (hello, request responses) are only validated and has_updates() returns false.
+ **/
+class SignalKDeltaParser
+{
+public:
+    SignalKDeltaParser(const char *data, int length);
+    /**
+     * @brief Parses the message and invokes callback for every value in updates[].values[]
+     * @return false if message isn't valid JSON object
+     **/
+    bool parse(delta_value_callback callback);
+    bool has_updates() { return has_updates_; }
+    int get_value_count() { return value_count_; }
+
+private:
+    const char *data_;
+    const char *end_;
+    const char *pos_;
+    bool has_updates_ = false;
+    int value_count_ = 0;
+
+    void skip_whitespace();
+    bool consume(char c);
+    bool read_string(const char *&str, int &len);
+    bool skip_value(const char **start, int *len);
+    template <typename F>
+    bool walk_object(F member);
+    template <typename F>
+    bool walk_array(F element);
+    bool parse_updates(delta_value_callback &callback);
+    bool parse_values(delta_value_callback &callback);
+    bool parse_value(delta_value_callback &callback);
+    static bool key_equals(const char *key, int key_len, const char *literal);
+};
@@ -0,0 +1,187 @@
+#include "signalk_frame_filter.h"
+#include <string.h>
+#include "esp_log.h"
+#include "signalk_path_index.h"
+
+static const char *FILTER_TAG = "SK_FILTER";
+
+#define KEY_UPDATES "\"updates\""
+#define KEY_CONTEXT "\"context\""
+#define KEY_REQUEST_ID "\"requestId\""
+#define KEY_SELF "\"self\""
+#define KEY_PATH "\"path\""
+#define KEY_LEN(key) (sizeof(key) - 1)
+
+static const char *SELF_ALIAS = "vessels.self";
+static const char *NOTIFICATIONS_PREFIX = "notifications.";
+
+const char *SignalKFrameFilter::find_key(const char *start, const char *end, const char *key, int key_len)
+{
+    // quotes are the most frequent character in JSON, so the first letter of the key is searched for instead
+    start++;
+    while (end - start >= key_len - 1)
+    {
+        auto found = (const char *)memchr(start, key[1], end - start - key_len + 2);
+        if (found == NULL)
+        {
+            return NULL;
+        }
+
+        if (found[-1] == '"' && memcmp(found + 1, key + 2, key_len - 2) == 0)
+        {
+            return found - 1;
+        }
+
+        start = found + 1;
+    }
+
+    return NULL;
+}
+
+bool SignalKFrameFilter::read_string_value(const char *key_end, const char *end, const char *&value, int &value_len)
+{
+    auto pos = key_end;
+
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+    {
+        pos++;
+    }
+
+    if (pos >= end || *pos != ':')
+    {
+        return false;
+    }
+    pos++;
+
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+    {
+        pos++;
+    }
+
+    if (pos >= end || *pos != '"')
+    {
+        return false;
+    }
+    pos++;
+
+    // contexts and paths don't contain escaped characters, string with backslash is treated as unknown
+    auto closing = (const char *)memchr(pos, '"', end - pos);
+    if (closing == NULL || memchr(pos, '\\', closing - pos) != NULL)
+    {
+        return false;
+    }
+
+    value = pos;
+    value_len = closing - pos;
+
+    return true;
+}
+
+bool SignalKFrameFilter::is_self(const char *context, int context_len)
+{
+    if (context_len == (int)strlen(SELF_ALIAS) && memcmp(context, SELF_ALIAS, context_len) == 0)
+    {
+        return true;
+    }
+
+    // until hello is received self context isn't known, so nothing is rejected
+    return self_len_ == 0 || (context_len == self_len_ && memcmp(context, self_, context_len) == 0);
+}
+
+bool SignalKFrameFilter::has_wanted_path(const char *start, const char *end, bool low_power)
+{
+    const char *path;
+    int path_len;
+    int prefix_len = strlen(NOTIFICATIONS_PREFIX);
+
+    // "path" keys inside values only cause false positives, which are filtered by parser later
+    while ((start = find_key(start, end, KEY_PATH, KEY_LEN(KEY_PATH))) != NULL)
+    {
+        start += KEY_LEN(KEY_PATH);
+
+        if (!read_string_value(start, end, path, path_len))
+        {
+            // unexpected format - let parser decide
+            return true;
+        }
+
+        if (path_len > prefix_len && memcmp(path, NOTIFICATIONS_PREFIX, prefix_len) == 0)
+        {
+            return true;
+        }
+
+        if (!low_power && SignalKPathIndex::find(path, path_len) != SK_PATH_ID_NONE)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SignalKFrameType_t SignalKFrameFilter::classify(const char *data, int length, bool low_power)
+{
+    auto end = data + length;
+    auto ret = SK_FRAME_OTHER;
+    auto updates = find_key(data, end, KEY_UPDATES, KEY_LEN(KEY_UPDATES));
+
+    if (updates != NULL)
+    {
+        const char *context;
+        int context_len;
+        // only context before updates is surely top level member, context found inside of updates could be part of value
+        auto context_key = find_key(data, updates, KEY_CONTEXT, KEY_LEN(KEY_CONTEXT));
+
+        if (context_key != NULL && read_string_value(context_key + KEY_LEN(KEY_CONTEXT), updates, context, context_len) &&
+            !is_self(context, context_len))
+        {
+            ret = SK_FRAME_DELTA_OTHER_CONTEXT;
+        }
+        else if (!has_wanted_path(updates, end, low_power))
+        {
+            ret = SK_FRAME_DELTA_UNBOUND;
+        }
+        else
+        {
+            ret = SK_FRAME_DELTA;
+        }
+    }
+    else if (find_key(data, end, KEY_REQUEST_ID, KEY_LEN(KEY_REQUEST_ID)) != NULL)
+    {
+        ret = SK_FRAME_REQUEST;
+    }
+    else
+    {
+        const char *self;
+        int self_len;
+        auto self_key = find_key(data, end, KEY_SELF, KEY_LEN(KEY_SELF));
+
+        if (self_key != NULL && read_string_value(self_key + KEY_LEN(KEY_SELF), end, self, self_len))
+        {
+            ret = SK_FRAME_HELLO;
+
+            if (self_len < SK_SELF_CONTEXT_MAX)
+            {
+                memcpy(self_, self, self_len);
+                self_[self_len] = '\0';
+                self_len_ = self_len;
+                ESP_LOGI(FILTER_TAG, "Self context is %s", self_);
+            }
+        }
+    }
+
+    if (ret == SK_FRAME_DELTA_OTHER_CONTEXT)
+    {
+        other_context_++;
+    }
+    else if (ret == SK_FRAME_DELTA_UNBOUND)
+    {
+        unbound_++;
+    }
+    else
+    {
+        passed_++;
+    }
+
+    return ret;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+#define SK_SELF_CONTEXT_MAX 96 // "vessels.urn:mrn:signalk:uuid:..." or "vessels.urn:mrn:imo:mmsi:..."
+
+enum SignalKFrameType_t
+{
+    SK_FRAME_DELTA,               // delta of self vessel with at least one wanted path
+    SK_FRAME_DELTA_OTHER_CONTEXT, // delta of other vessel (AIS target), rejected
+    SK_FRAME_DELTA_UNBOUND,       // delta without any bound path or notification, rejected
+    SK_FRAME_HELLO,               // server hello, self context is learned from it
+    SK_FRAME_REQUEST,             // response to access or PUT request
+    SK_FRAME_OTHER
+};
+
+/**
+ * @brief Classifies websocket messages by scanning raw bytes for keys (memchr + memcmp), so deltas which wouldn't
+ * update anything are rejected before they are parsed. The scan is conservative - when the message structure is
+ * ambiguous it's passed to the parser. Messages are expected to be complete (see WebsocketFrameAssembler).
+ *
+ * Benchmark: tools/host/frame_filter_bench on host. On the watch record AIS-heavy stream from tools/signalk_standin
+ * (--ais option) with "capture" enabled, then replay it with "replay": "fast" and compare "replay" stage of pipeline
+ * stats with "prefilter" on and off.
+ **/
+class SignalKFrameFilter
+{
+public:
+    /**
+     * @brief Classifies the message, wanted paths are interned in SignalKPathIndex
+     * @param low_power only notifications are wanted in low power mode
+     **/
+    SignalKFrameType_t classify(const char *data, int length, bool low_power);
+    static bool is_rejected(SignalKFrameType_t type) { return type == SK_FRAME_DELTA_OTHER_CONTEXT || type == SK_FRAME_DELTA_UNBOUND; }
+    const char *get_self() { return self_; }
+    uint32_t get_passed_count() { return passed_; }
+    uint32_t get_other_context_count() { return other_context_; }
+    uint32_t get_unbound_count() { return unbound_; }
+
+private:
+    char self_[SK_SELF_CONTEXT_MAX] = {0};
+    int self_len_ = 0;
+    uint32_t passed_ = 0;
+    uint32_t other_context_ = 0;
+    uint32_t unbound_ = 0;
+
+    bool is_self(const char *context, int context_len);
+    bool has_wanted_path(const char *start, const char *end, bool low_power);
+    /// Finds quoted key ("key") in data, key has to include quotes
+    static const char *find_key(const char *start, const char *end, const char *key, int key_len);
+    /// Reads string value following the key (after colon), it returns false if value isn't string
+    static bool read_string_value(const char *key_end, const char *end, const char *&value, int &value_len);
+};
@@ -0,0 +1,124 @@
+#include "signalk_path_index.h"
+#include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include "esp_log.h"
+
+struct PathIndexEntry_t
+{
+    char *path;
+    int path_len;
+    uint32_t hash;
+};
+
+static const char *PATH_INDEX_TAG = "PATH_INDEX";
+static PathIndexEntry_t paths[SK_PATH_INDEX_MAX];
+// slots and count are published with release stores after the entry is filled, readers use acquire loads,
+// so a lookup on another core never sees a slot pointing to half initialized entry
+static std::atomic<sk_path_id_t> table[SK_PATH_INDEX_CAPACITY];
+static std::atomic<int> path_count(0);
+static std::atomic<bool> table_initialized(false);
+
+/// FNV-1a hash of the path
+uint32_t SignalKPathIndex::hash(const char *path, int path_len)
+{
+    uint32_t ret = 2166136261u;
+
+    for (int i = 0; i < path_len; i++)
+    {
+        ret ^= (uint8_t)path[i];
+        ret *= 16777619u;
+    }
+
+    return ret;
+}
+
+sk_path_id_t SignalKPathIndex::find(const char *path, int path_len)
+{
+    if (!table_initialized.load(std::memory_order_acquire))
+    {
+        return SK_PATH_ID_NONE;
+    }
+
+    uint32_t path_hash = hash(path, path_len);
+    uint32_t slot = path_hash & (SK_PATH_INDEX_CAPACITY - 1);
+    sk_path_id_t id;
+
+    while ((id = table[slot].load(std::memory_order_acquire)) != SK_PATH_ID_NONE)
+    {
+        const PathIndexEntry_t &entry = paths[id];
+        if (entry.hash == path_hash && entry.path_len == path_len && memcmp(entry.path, path, path_len) == 0)
+        {
+            return id;
+        }
+
+        slot = (slot + 1) & (SK_PATH_INDEX_CAPACITY - 1);
+    }
+
+    return SK_PATH_ID_NONE;
+}
+
+sk_path_id_t SignalKPathIndex::intern(const char *path, int path_len)
+{
+    if (!table_initialized.load(std::memory_order_relaxed))
+    {
+        for (auto &slot : table)
+        {
+            slot.store(SK_PATH_ID_NONE, std::memory_order_relaxed);
+        }
+        table_initialized.store(true, std::memory_order_release);
+    }
+
+    sk_path_id_t ret = find(path, path_len);
+
+    if (ret == SK_PATH_ID_NONE)
+    {
+        int count = path_count.load(std::memory_order_relaxed);
+        if (count >= SK_PATH_INDEX_MAX)
+        {
+            ESP_LOGE(PATH_INDEX_TAG, "Path index is full, unable to add %.*s!", path_len, path);
+            return SK_PATH_ID_NONE;
+        }
+
+        uint32_t path_hash = hash(path, path_len);
+        uint32_t slot = path_hash & (SK_PATH_INDEX_CAPACITY - 1);
+
+        while (table[slot].load(std::memory_order_relaxed) != SK_PATH_ID_NONE)
+        {
+            slot = (slot + 1) & (SK_PATH_INDEX_CAPACITY - 1);
+        }
+
+        ret = count;
+        PathIndexEntry_t &entry = paths[ret];
+        entry.path = (char *)malloc(path_len + 1);
+        memcpy(entry.path, path, path_len);
+        entry.path[path_len] = '\0';
+        entry.path_len = path_len;
+        entry.hash = path_hash;
+        path_count.store(count + 1, std::memory_order_release);
+        table[slot].store(ret, std::memory_order_release);
+        ESP_LOGI(PATH_INDEX_TAG, "Interned path %s with id=%d", entry.path, ret);
+    }
+
+    return ret;
+}
+
+sk_path_id_t SignalKPathIndex::intern(const char *path)
+{
+    return intern(path, strlen(path));
+}
+
+const char *SignalKPathIndex::get_path(sk_path_id_t id)
+{
+    if (id < path_count.load(std::memory_order_acquire))
+    {
+        return paths[id].path;
+    }
+
+    return NULL;
+}
+
+int SignalKPathIndex::count()
+{
+    return path_count.load(std::memory_order_acquire);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#define SK_PATH_INDEX_MAX 128       // maximum number of interned paths
+#define SK_PATH_INDEX_CAPACITY 256  // hash table size, must be power of 2 and larger than SK_PATH_INDEX_MAX
+#define SK_PATH_ID_NONE 0xFFFF
+
+typedef uint16_t sk_path_id_t;
+
+/**
+ * @brief Interns SignalK paths into small integer IDs, so incoming values can be dispatched by single lookup
+ * instead of comparing path strings. Paths are interned when views are loaded, lookups are done with raw path slices
+ * (no String allocation) in open addressing hash table. Table has fixed size and interned paths are never removed.
+ * Paths are interned from one task at a time (GUI task loading views), lookups are safe from any task even while
+ * paths are being interned - new entries are published with release / acquire atomics.
+ **/
+class SignalKPathIndex
+{
+public:
+    /// Returns ID of the path, path is added into the index if it isn't there yet (returns SK_PATH_ID_NONE if index is full)
+    static sk_path_id_t intern(const char *path, int path_len);
+    static sk_path_id_t intern(const char *path);
+    /// Returns ID of already interned path or SK_PATH_ID_NONE
+    static sk_path_id_t find(const char *path, int path_len);
+    static const char *get_path(sk_path_id_t id);
+    static int count();
+    /// FNV-1a hash of the path, it's stable across reboots (unlike path IDs)
+    static uint32_t hash(const char *path, int path_len);
+
+private:
+    SignalKPathIndex() {}
+};
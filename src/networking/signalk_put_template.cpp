@@ -0,0 +1,63 @@
+#include "signalk_put_template.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *PUT_TEMPLATE_TAG = "PUT_TPL";
+
+SignalKPutTemplate::~SignalKPutTemplate()
+{
+    free(text_);
+}
+
+bool SignalKPutTemplate::compile(const char *path, JsonVariantConst value)
+{
+    char id_slot[SK_PUT_ID_LEN + 1];
+    memset(id_slot, '0', SK_PUT_ID_LEN);
+    id_slot[SK_PUT_ID_LEN] = '\0';
+
+    DynamicJsonDocument request(SK_PUT_TEMPLATE_MAX);
+    // requestId is serialized first so its position doesn't depend on path or value
+    request["requestId"] = (const char *)id_slot;
+    JsonObject put_data = request.createNestedObject("put");
+    put_data["path"] = path;
+    put_data["value"] = value;
+
+    auto length = measureJson(request);
+    if (request.overflowed() || length >= SK_PUT_TEMPLATE_MAX)
+    {
+        ESP_LOGE(PUT_TEMPLATE_TAG, "PUT request of %s is too large!", path);
+        return false;
+    }
+
+    free(text_);
+    text_ = (char *)malloc(length + 1);
+    if (text_ == NULL)
+    {
+        length_ = 0;
+        return false;
+    }
+
+    length_ = serializeJson(request, text_, length + 1);
+    id_offset_ = strlen("{\"requestId\":\"");
+    ESP_LOGI(PUT_TEMPLATE_TAG, "Compiled PUT template (len=%d): %s", length_, text_);
+
+    return true;
+}
+
+bool SignalKPutTemplate::compile(const char *path, bool value)
+{
+    StaticJsonDocument<16> value_doc;
+    value_doc.set(value);
+
+    return compile(path, value_doc.as<JsonVariantConst>());
+}
+
+const char *SignalKPutTemplate::render(const char *request_id)
+{
+    if (text_ != NULL)
+    {
+        memcpy(text_ + id_offset_, request_id, SK_PUT_ID_LEN);
+    }
+
+    return text_;
+}
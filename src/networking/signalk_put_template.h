@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include "ArduinoJson.h"
+#include "system/request_id.h"
+
+#define SK_PUT_TEMPLATE_MAX 512 // maximum size of rendered PUT request
+#define SK_PUT_ID_LEN REQUEST_ID_LEN // length of requestId slot
+
+/**
+ * @brief PUT request serialized once when view is loaded. Sending it only patches requestId slot,
+ * so there are no JSON library calls when user interacts with the watch.
+ **/
+class SignalKPutTemplate
+{
+public:
+    ~SignalKPutTemplate();
+    /// Serializes PUT of value to path with empty requestId slot, returns false if the request is too large
+    bool compile(const char *path, JsonVariantConst value);
+    bool compile(const char *path, bool value);
+    bool is_compiled() { return text_ != NULL; }
+    /**
+     * @brief Writes request_id (SK_PUT_ID_LEN chars) into the template
+     * @return request text, valid until next render() call
+     **/
+    const char *render(const char *request_id);
+    int get_length() { return length_; }
+
+private:
+    char *text_ = NULL;
+    int length_ = 0;
+    int id_offset_ = 0;
+};
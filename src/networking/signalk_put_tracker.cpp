@@ -0,0 +1,190 @@
+#include "signalk_put_tracker.h"
+#include <string.h>
+#include <vector>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "system/pipeline_stats.h"
+
+static const char *PUT_TAG = "PUT";
+
+SignalKPutTracker::SignalKPutTracker()
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+int SignalKPutTracker::find(const char *request_id)
+{
+    for (int i = 0; i < SK_PUT_MAX_PENDING; i++)
+    {
+        if (pending_[i].used && strcmp(pending_[i].request_id, request_id) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool SignalKPutTracker::add(const char *request_id, put_callback callback)
+{
+    bool ret = false;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < SK_PUT_MAX_PENDING; i++)
+    {
+        auto &put = pending_[i];
+        if (!put.used)
+        {
+            strlcpy(put.request_id, request_id, sizeof(put.request_id));
+            put.used = true;
+            put.finished = false;
+            put.status_code = 0;
+            put.sent_us = esp_timer_get_time();
+            put.callback = callback;
+            ret = true;
+            break;
+        }
+    }
+    xSemaphoreGive(lock_);
+
+    if (!ret)
+    {
+        ESP_LOGW(PUT_TAG, "Too many pending PUT requests, %s isn't tracked!", request_id);
+    }
+
+    return ret;
+}
+
+void SignalKPutTracker::finish(const char *request_id, PutResult_t result, int status_code)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    auto index = find(request_id);
+    if (index >= 0 && !pending_[index].finished)
+    {
+        auto &put = pending_[index];
+        put.finished = true;
+        put.result = result;
+        put.status_code = status_code;
+        put.rtt_us = (uint32_t)(esp_timer_get_time() - put.sent_us);
+    }
+    xSemaphoreGive(lock_);
+}
+
+bool SignalKPutTracker::handle_response(const char *request_id, const char *state, int status_code)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    bool tracked = find(request_id) >= 0;
+    xSemaphoreGive(lock_);
+
+    if (tracked)
+    {
+        ESP_LOGI(PUT_TAG, "PUT %s state=%s status=%d", request_id, state, status_code);
+
+        // PENDING just confirms server accepted the request, we wait for COMPLETED
+        if (strcmp(state, "COMPLETED") == 0)
+        {
+            finish(request_id, status_code >= 200 && status_code < 300 ? PUT_COMPLETED : PUT_FAILED, status_code);
+        }
+    }
+
+    return tracked;
+}
+
+void SignalKPutTracker::handle_not_sent(const char *request_id)
+{
+    finish(request_id, PUT_NOT_SENT, 0);
+}
+
+void SignalKPutTracker::remove(const char *request_id)
+{
+    put_callback callback;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    auto index = find(request_id);
+    if (index >= 0)
+    {
+        // callback is released outside of the lock
+        callback = pending_[index].callback;
+        pending_[index].callback = nullptr;
+        pending_[index].used = false;
+    }
+    xSemaphoreGive(lock_);
+}
+
+void SignalKPutTracker::cancel(const char *request_id)
+{
+    put_callback callback;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    auto index = find(request_id);
+    if (index >= 0)
+    {
+        // callback is released outside of the lock
+        callback = pending_[index].callback;
+        pending_[index].callback = nullptr;
+    }
+    xSemaphoreGive(lock_);
+}
+
+void SignalKPutTracker::process()
+{
+    struct Result_t
+    {
+        PutResult_t result;
+        int status_code;
+        put_callback callback;
+    };
+    std::vector<Result_t> results;
+    auto now = esp_timer_get_time();
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < SK_PUT_MAX_PENDING; i++)
+    {
+        auto &put = pending_[i];
+        if (!put.used)
+        {
+            continue;
+        }
+
+        if (!put.finished && now - put.sent_us > SK_PUT_TIMEOUT * 1000LL)
+        {
+            put.finished = true;
+            put.result = PUT_TIMEOUT;
+            put.status_code = 0;
+        }
+
+        if (put.finished)
+        {
+            if (put.result == PUT_COMPLETED || put.result == PUT_FAILED)
+            {
+                pipeline_stats_record(STAGE_PUT_RTT, put.rtt_us);
+            }
+
+            if (put.result == PUT_COMPLETED)
+            {
+                completed_++;
+            }
+            else if (put.result == PUT_TIMEOUT)
+            {
+                timeouts_++;
+            }
+            else
+            {
+                failed_++;
+            }
+
+            results.push_back({put.result, put.status_code, put.callback});
+            put.callback = nullptr;
+            put.used = false;
+        }
+    }
+    xSemaphoreGive(lock_);
+
+    for (auto &result : results)
+    {
+        if (result.callback != nullptr)
+        {
+            result.callback(result.result, result.status_code);
+        }
+    }
+}
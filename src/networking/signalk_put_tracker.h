@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define SK_PUT_MAX_PENDING 8     // maximum number of PUT requests waiting for response
+#define SK_PUT_TIMEOUT 5000      // ms to wait for COMPLETED response
+#define SK_PUT_REQUEST_ID_MAX 40 // request ID + terminator (longer IDs from server are truncated)
+
+enum PutResult_t
+{
+    PUT_COMPLETED, // server completed request with 2xx status code
+    PUT_FAILED,    // server completed request with error status code
+    PUT_TIMEOUT,   // no COMPLETED response in time
+    PUT_NOT_SENT   // request wasn't sent (queue full, socket disconnected)
+};
+
+/// Called from GUI task with result of PUT request and status code from server (0 if there is none)
+typedef std::function<void(PutResult_t, int)> put_callback;
+
+/**
+ * @brief Table of PUT requests waiting for response from server, correlated by requestId.
+ * Responses are matched on websocket task, timeouts and callbacks are handled by process() on GUI task,
+ * so callbacks can touch LVGL objects. Round trip times are recorded into pipeline stats.
+ **/
+class SignalKPutTracker
+{
+public:
+    SignalKPutTracker();
+    /// Registers new request before it's sent, returns false if table is full
+    bool add(const char *request_id, put_callback callback);
+    /**
+     * @brief Handles request status message from server (websocket task)
+     * @return true if request ID belongs to tracked PUT request
+     **/
+    bool handle_response(const char *request_id, const char *state, int status_code);
+    /// Marks request as failed because it couldn't be sent (sender task)
+    void handle_not_sent(const char *request_id);
+    /// Stops tracking request without invoking its callback (request was rejected before it was queued)
+    void remove(const char *request_id);
+    /// Drops callback of request (its owner is gone or not interested), response is still matched and counted
+    void cancel(const char *request_id);
+    /// Invokes callbacks of finished and timed out requests, it must be called from GUI task
+    void process();
+    uint32_t get_completed_count() { return completed_; }
+    uint32_t get_failed_count() { return failed_; }
+    uint32_t get_timeout_count() { return timeouts_; }
+
+private:
+    struct PendingPut_t
+    {
+        char request_id[SK_PUT_REQUEST_ID_MAX] = {0};
+        bool used = false;
+        bool finished = false;
+        PutResult_t result = PUT_TIMEOUT;
+        int status_code = 0;
+        int64_t sent_us = 0;
+        uint32_t rtt_us = 0;
+        put_callback callback;
+    };
+
+    PendingPut_t pending_[SK_PUT_MAX_PENDING];
+    SemaphoreHandle_t lock_;
+    uint32_t completed_ = 0;
+    uint32_t failed_ = 0;
+    uint32_t timeouts_ = 0;
+
+    int find(const char *request_id);
+    void finish(const char *request_id, PutResult_t result, int status_code);
+};
@@ -1,34 +1,18 @@
 #include "signalk_socket.h"
+#include "signalk_delta_parser.h"
+#include "signalk_path_index.h"
 #include "system/uuid.h"
+#include "system/request_id.h"
 #include "system/events.h"
+#include "system/async_dispatcher.h"
+#include "networking/http_request.h"
 #include "ui/localization.h"
-#include "esp_transport.h"
+#include "system/psram.h"
+#include "system/pipeline_stats.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
 #define LOG_WS_DATA 0
 static const char *WS_TAG = "WS";
-const char UnsubscribeMessage[] = "{\"context\":\"*\",\"unsubscribe\":[{\"path\":\"*\"}]}";
-
-struct esp_websocket_client_info
-{
-    esp_event_loop_handle_t event_handle;
-    void *transport_list;
-    esp_transport_handle_t transport;
-    void *config;
-    int state;
-    uint64_t keepalive_tick_ms;
-    uint64_t reconnect_tick_ms;
-    uint64_t ping_tick_ms;
-    int wait_timeout_ms;
-    int auto_reconnect;
-    bool run;
-    EventGroupHandle_t status_bits;
-    xSemaphoreHandle lock;
-    char *rx_buffer;
-    char *tx_buffer;
-    int buffer_size;
-    int last_opcode;
-    int payload_len;
-    int payload_offset;
-};
 
 void SignalKSocket::ws_event_handler(void *arg, esp_event_base_t event_base,
                                      int32_t event_id, void *event_data)
@@ -44,24 +28,44 @@ void SignalKSocket::ws_event_handler(void *arg, esp_event_base_t event_base,
         else if (event_id == WEBSOCKET_EVENT_CONNECTED)
         {
             ESP_LOGI(WS_TAG, "Web socket connected to server!");
-            socket->reconnect_counter_ = socket->reconnect_count_; // restore reconnect counter to 3
-            socket->delta_counter = 0;                             // clear the socket delta counter
+            socket->reconnect_.on_connected(socket->current_server_);
+            socket->keepalive_.on_connected(esp_timer_get_time());
+            if (!is_low_power())
+            {
+                xTimerStart(socket->liveness_timer_, 0);
+            }
+            socket->delta_counter = 0;                // clear the socket delta counter
+            socket->frame_assembler_.reset();         // drop any partial message from previous connection
+            if (!socket->current_cached_ip_)
+            {
+                socket->resolve_server_ip(socket->current_server_, socket->reconnect_.get_server(socket->current_server_).host);
+            }
+            socket->start_view_measurement();
+            if (socket->capture_enabled_)
+            {
+                socket->capture_.start();
+            }
 
             socket->update_status(WebsocketState_t::WS_Connected);
 
-            // if token is empty, request access
-            if (socket->token.isEmpty())
+            // if this server didn't issue a token yet, request access
+            if (socket->reconnect_.get_token(socket->current_server_).isEmpty())
             {
                 socket->send_token_permission();
             }
             else // token isn't empty send subscription requests
             {
                 socket->update_subscriptions(true);
+                socket->request_snapshot();
             }
         }
         else if (event_id == WEBSOCKET_EVENT_DISCONNECTED)
         {
+            socket->capture_.stop();
+            xTimerStop(socket->liveness_timer_, 0);
             socket->update_status(WebsocketState_t::WS_Offline);
+            ESP_LOGI(WS_TAG, "Prefilter passed %u messages, rejected %u of other vessels and %u without bound path.",
+                     socket->frame_filter_.get_passed_count(), socket->frame_filter_.get_other_context_count(), socket->frame_filter_.get_unbound_count());
             ESP_LOGI(WS_TAG, "Web socket disconnected from server! Wifi enabled=%d", (int)socket->wifi->is_enabled());
             if (!socket->wifi->is_connected())
             {
@@ -70,38 +74,44 @@ void SignalKSocket::ws_event_handler(void *arg, esp_event_base_t event_base,
             }
             else
             {
-                ESP_LOGI(WS_TAG, "Unexpected disconnection. Will try reconnect for %d times.", socket->reconnect_counter_);
-
-                if (socket->reconnect_counter_ == 0)
-                {
-                    post_gui_warning(GuiMessageCode_t::GUI_WARN_SK_LOST_CONNECTION);
-                    socket->disconnect();
-                }
-                else
-                {
-                    socket->reconnect_counter_--;
-                }
+                ESP_LOGI(WS_TAG, "Unexpected disconnection.");
+                socket->schedule_reconnect();
             }
         }
         else if (event_id == WEBSOCKET_EVENT_DATA)
         {
             ESP_LOGI(WS_TAG, "WEBSOCKET_EVENT_DATA");
             ESP_LOGI(WS_TAG, "Received opcode=%d", data->op_code);
+            // any frame (including pong) proves that server is alive
+            socket->keepalive_.on_received(esp_timer_get_time());
             if (data->op_code == 0x08 && data->data_len == 2)
             {
                 ESP_LOGW(WS_TAG, "Received closed message with code=%d", 256 * data->data_ptr[0] + data->data_ptr[1]);
             }
             else
             {
-                if (data->data_len > 0)
+                // empty continuation frame can still end fragmented message
+                if (data->data_len > 0 || data->op_code == WS_OPCODE_CONTINUATION)
                 {
-                    socket->parse_data(data->data_len, data->data_ptr);
+                    socket->rx_bytes_ += data->data_len;
+                    ESP_LOGD(WS_TAG, "Total payload length=%d, data_len=%d, current payload offset=%d", data->payload_len, data->data_len, data->payload_offset);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+                    int fin = data->fin ? 1 : 0;
+#else
+                    int fin = WS_FIN_UNKNOWN; // client doesn't report FIN bit, assembler finds end of JSON message
+#endif
+                    // large messages (initial snapshots) are delivered in multiple chunks or continuation frames, parse them once they are complete
+                    if (socket->frame_assembler_.append(data->op_code, data->data_ptr, data->data_len, data->payload_len, data->payload_offset, fin) &&
+                        socket->frame_assembler_.get_length() > 0 && !SignalKCapture::is_replaying())
+                    {
+                        socket->capture_.record(socket->frame_assembler_.get_data(), socket->frame_assembler_.get_length());
+                        socket->parse_data(socket->frame_assembler_.get_length(), socket->frame_assembler_.get_data());
 #if LOG_WS_DATA == 1
-                    ESP_LOGW(WS_TAG, "Received=%.*s", data->data_len, (char *)data->data_ptr);
+                        ESP_LOGW(WS_TAG, "Received=%.*s", socket->frame_assembler_.get_length(), socket->frame_assembler_.get_data());
 #endif
+                    }
                 }
             }
-            ESP_LOGW(WS_TAG, "Total payload length=%d, data_len=%d, current payload offset=%d\r\n", data->payload_len, data->data_len, data->payload_offset);
         }
     }
 }
@@ -116,6 +126,11 @@ SignalKSocket::SignalKSocket(WifiManager *wifi) : Configurable("/config/websocke
 
     wifi->attach(this);
     this->wifi = wifi;
+    websocket_lock_ = xSemaphoreCreateMutex();
+    subscriptions_lock_ = xSemaphoreCreateMutex();
+    xTaskCreate(sender_task, "ws_send", 3072, this, 5, NULL);
+    reconnect_timer_ = xTimerCreate("sk_reconnect", pdMS_TO_TICKS(SK_RECONNECT_BASE_DELAY), pdFALSE, this, reconnect_timer_callback);
+    liveness_timer_ = xTimerCreate("sk_liveness", pdMS_TO_TICKS(WS_LIVENESS_CHECK_PERIOD), pdTRUE, this, liveness_timer_callback);
 
     if (wifi != NULL)
     {
@@ -124,20 +139,47 @@ SignalKSocket::SignalKSocket(WifiManager *wifi) : Configurable("/config/websocke
 }
 
 bool SignalKSocket::connect()
+{
+    xTimerStop(reconnect_timer_, 0);
+    reconnect_.reset();
+    reconnect_.set_primary(server, port);
+    auto primary = reconnect_.get_server(0);
+
+    // last resolved IP of configured server is used first, it saves DNS / mDNS lookup after wake up
+    if (!primary.last_ip.isEmpty())
+    {
+        return connect_to(primary.last_ip, port, 0, true);
+    }
+
+    return connect_to(server, port, 0, false);
+}
+
+bool SignalKSocket::connect_to(const String &address, int port, int server, bool cached_ip)
 {
     bool ret = false;
 
-    ESP_LOGI(WS_TAG, "Connecting socket to server %s:%d", server.c_str(), port);
+    ESP_LOGI(WS_TAG, "Connecting socket to server %s:%d", address.c_str(), port);
+
+    if (websocket_initialized && value == WS_Offline)
+    {
+        // client of lost connection is stopped, but it has to be released
+        destroy_client();
+    }
 
-    if (value == WS_Offline && server != "" && port > 0 && wifi->is_connected())
+    if (value == WS_Offline && address != "" && port > 0 && wifi->is_connected())
     {
         char url[256];
-        sprintf(url, "/signalk/v1/stream?subscribe=none&token=%s", token.c_str());
+        // every server gets only the token it issued (failover servers can be discovered by mDNS)
+        snprintf(url, sizeof(url), "/signalk/v1/stream?subscribe=none&token=%s", reconnect_.get_token(server).c_str());
         esp_websocket_client_config_t ws_cfg = {
-            .host = server.c_str(),
+            .host = address.c_str(),
             .path = url};
         ws_cfg.port = port;
-        reconnect_counter_ = reconnect_count_; // restore reconnect counter
+        // reconnection is scheduled by this class (backoff, failover)
+        ws_cfg.disable_auto_reconnect = true;
+        keepalive_.configure(ws_cfg, is_low_power());
+        current_server_ = server;
+        current_cached_ip_ = cached_ip;
 
         ESP_LOGI(WS_TAG, "Initializing websocket ws://%s:%d%s...", ws_cfg.host, ws_cfg.port, url);
 
@@ -163,12 +205,28 @@ bool SignalKSocket::connect()
 }
 
 bool SignalKSocket::disconnect()
+{
+    xTimerStop(reconnect_timer_, 0);
+    reconnect_.reset();
+
+    return destroy_client();
+}
+
+bool SignalKSocket::destroy_client()
 {
     auto ret = false;
 
+    xTimerStop(liveness_timer_, 0);
+
     if (websocket_initialized && websocket != NULL)
     {
         ESP_LOGI(WS_TAG, "Disconnecting websocket...");
+        xSemaphoreTake(websocket_lock_, portMAX_DELAY);
+        // lock keeps sender task from taking the handle again, message being sent is bounded by its deadline
+        while (sending_)
+        {
+            delay(10);
+        }
 
         if (esp_websocket_client_is_connected(websocket))
         {
@@ -188,6 +246,10 @@ bool SignalKSocket::disconnect()
             ESP_LOGE(WS_TAG, "Failed to cleanup websocket with error %d", clenaup);
         }
 
+        xSemaphoreGive(websocket_lock_);
+        // messages for old connection make no sense (subscriptions are sent again after connect)
+        outbound_.clear();
+
         update_status(WebsocketState_t::WS_Offline);
         ret = true;
     }
@@ -199,9 +261,25 @@ void SignalKSocket::load_config_from_file(const JsonObject &json)
 {
     server = json["server"].as<String>();
     port = json["port"].as<int>();
-    token = json["token"].as<String>();
     clientId = json["id"].as<String>();
     sync_time_with_server = json["synctime"].as<bool>();
+    background_period_ = json["bgperiod"].as<uint>();
+    snapshot_enabled_ = json["snapshot"] | true;
+    prefilter_enabled_ = json["prefilter"] | true;
+    keepalive_.set_ping_intervals(json["ping"] | WS_PING_INTERVAL_DEFAULT, json["lpping"] | WS_PING_INTERVAL_LOW_POWER_DEFAULT);
+    capture_enabled_ = json["capture"].as<bool>();
+    replay_mode_ = (ReplayMode_t)json["replay"].as<int>();
+
+    reconnect_.set_primary(server, port);
+    reconnect_.set_last_ip(0, json["lastip"].as<String>());
+    reconnect_.set_token(0, json["token"].as<String>());
+    if (json.containsKey("servers"))
+    {
+        for (JsonObject known : json["servers"].as<JsonArray>())
+        {
+            reconnect_.add_server(known["host"].as<String>(), known["port"].as<int>(), known["ip"] | "", known["token"] | "");
+        }
+    }
     ESP_LOGI(WS_TAG, "Loaded config with server %s:%d", server.c_str(), port);
 }
 
@@ -209,9 +287,32 @@ void SignalKSocket::save_config_to_file(JsonObject &json)
 {
     json["server"] = server;
     json["port"] = port;
-    json["token"] = token;
     json["id"] = clientId;
     json["synctime"] = sync_time_with_server;
+    json["bgperiod"] = background_period_;
+    json["snapshot"] = snapshot_enabled_;
+    json["prefilter"] = prefilter_enabled_;
+    json["ping"] = keepalive_.get_awake_ping_interval();
+    json["lpping"] = keepalive_.get_low_power_ping_interval();
+    json["capture"] = capture_enabled_;
+    json["replay"] = (int)replay_mode_;
+
+    auto servers = reconnect_.get_servers();
+    if (!servers.empty() && servers[0].host == server && servers[0].port == port)
+    {
+        json["lastip"] = servers[0].last_ip;
+        json["token"] = servers[0].token;
+    }
+
+    JsonArray known = json.createNestedArray("servers");
+    for (int i = 1; i < (int)servers.size(); i++)
+    {
+        JsonObject entry = known.createNestedObject();
+        entry["host"] = servers[i].host;
+        entry["port"] = servers[i].port;
+        entry["ip"] = servers[i].last_ip;
+        entry["token"] = servers[i].token;
+    }
 }
 
 bool updateSystemTime(String time, SignalKSocket *socket)
@@ -277,9 +378,280 @@ bool updateSystemTime(String time, SignalKSocket *socket)
     return ret;
 }
 
-void SignalKSocket::parse_data(int length, const char *data)
+/// Posts value to GUI, value which doesn't fit into SignalKValue_t is spilled to heap as raw JSON text
+static bool post_value_update(SignalKUpdate_t &update, const char *json, int json_len)
+{
+    if (update.value.parse(json, json_len))
+    {
+        post_gui_sk_dv_update(update);
+        return true;
+    }
+
+    char *spill = (char *)twatchsk::psram_malloc(json_len + 1);
+    if (spill == NULL)
+    {
+        ESP_LOGW(WS_TAG, "Unable to allocate %d bytes for value!", json_len);
+        return false;
+    }
+
+    memcpy(spill, json, json_len);
+    spill[json_len] = '\0';
+    update.value.type = SK_VALUE_SPILLED;
+    post_gui_sk_dv_update(update, spill);
+
+    return true;
+}
+
+void SignalKSocket::parse_data(int length, const char *data, PipelineStage_t stage)
 {
-    DynamicJsonDocument doc(4096);
+    auto start = esp_timer_get_time();
+    bool low_power = is_low_power();
+    auto type = prefilter_enabled_ ? frame_filter_.classify(data, length, low_power) : SK_FRAME_OTHER;
+
+    if (SignalKFrameFilter::is_rejected(type))
+    {
+        ESP_LOGV(WS_TAG, "Rejected message type=%d len=%d", (int)type, length);
+        pipeline_stats_record(stage, (uint32_t)(esp_timer_get_time() - start));
+        return;
+    }
+    else if (type == SK_FRAME_HELLO || type == SK_FRAME_REQUEST)
+    {
+        parse_message(length, data);
+        pipeline_stats_record(stage, (uint32_t)(esp_timer_get_time() - start));
+        return;
+    }
+
+    SignalKDeltaParser parser(data, length);
+    auto result = parser.parse([this, low_power](const SignalKDeltaValue_t &value)
+                               { handle_delta_value(value, low_power); });
+
+    if (result && parser.has_updates())
+    {
+        delta_counter++;
+        ESP_LOGD(WS_TAG, "Got delta with %d values from websocket with len=%d", parser.get_value_count(), length);
+    }
+    else
+    {
+        // hello message, request responses etc. are rare, so it's fine to parse them into JSON document
+        parse_message(length, data);
+    }
+
+    pipeline_stats_record(stage, (uint32_t)(esp_timer_get_time() - start));
+}
+
+void SignalKSocket::handle_delta_value(const SignalKDeltaValue_t &value, bool low_power)
+{
+    if (value.path_len > 14 && strncmp(value.path, "notifications.", 14) == 0)
+    {
+        char pathBuffer[128];
+        snprintf(pathBuffer, sizeof(pathBuffer), "%.*s", value.path_len, value.path);
+        String path = pathBuffer;
+        bool active = is_notification_active(path);
+        StaticJsonDocument<512> notificationJson;
+
+        if (deserializeJson(notificationJson, value.value, value.value_len) != DeserializationError::Ok)
+        {
+            ESP_LOGW(WS_TAG, "Unable to parse SK notification %s", path.c_str());
+            return;
+        }
+
+        JsonObject notification = notificationJson.as<JsonObject>();
+        String state = notification["state"].as<String>();
+        ESP_LOGI(WS_TAG, "Got SK notification %s with state %s, active=%d", path.c_str(), state.c_str(), active);
+
+        if (state == "alarm" || state == "alert" || state == "warn" || state == "emergency") // alarm is active we need to wake up the watch and show alert text on the display
+        {
+            if (!active)
+            {
+                String message = notification["message"];
+                // if the warning list is full, notification stays inactive and is shown with its next delta
+                if (post_gui_warning(message))
+                {
+                    activeNotifications.push_back(path);
+                }
+            }
+        }
+        else
+        {
+            remove_active_notification(path);
+        }
+    }
+    else if (!low_power)
+    {
+        SignalKUpdate_t update;
+        update.path_id = SignalKPathIndex::find(value.path, value.path_len);
+
+        // values without any bound component are dropped here
+        if (update.path_id != SK_PATH_ID_NONE)
+        {
+            mark_path_received(update.path_id);
+            update.timestamp = millis();
+            post_value_update(update, value.value, value.value_len);
+        }
+    }
+}
+
+bool SignalKSocket::start_replay()
+{
+    if (replay_mode_ == REPLAY_OFF)
+    {
+        return false;
+    }
+
+    ESP_LOGI(WS_TAG, "Starting replay of %s, live messages are dropped while replaying.", SK_CAPTURE_FILE);
+    bool ret = SignalKCapture::replay(SK_CAPTURE_FILE, replay_mode_, [this](int length, const char *data)
+                                      { parse_data(length, data, STAGE_REPLAY); });
+
+    // replay is one-shot benchmark, next boot is normal again
+    replay_mode_ = REPLAY_OFF;
+    save();
+
+    return ret;
+}
+
+void SignalKSocket::request_snapshot()
+{
+    // snapshot is taken from the server the websocket is connected to, with the token that server issued
+    auto target = reconnect_.get_server(current_server_);
+    if (!snapshot_enabled_ || target.token.isEmpty() || SignalKPathIndex::count() == 0)
+    {
+        return;
+    }
+
+    bool pending = false;
+    if (!snapshot_pending_.compare_exchange_strong(pending, true))
+    {
+        return;
+    }
+
+    // resolved address saves DNS / mDNS lookup
+    String address = target.last_ip.isEmpty() ? target.host : target.last_ip;
+    twatchsk::run_async("SK snapshot", [this, address, target]()
+                        {
+                            fetch_snapshot(address, target.port, target.token);
+                            snapshot_pending_ = false;
+                        });
+}
+
+void SignalKSocket::fetch_snapshot(const String &address, int port, const String &token)
+{
+    char url[256];
+    snprintf(url, sizeof(url), "http://%s:%d/signalk/v1/api/vessels/self", address.c_str(), port);
+
+    int length = 0;
+    int posted = 0;
+    auto start = esp_timer_get_time();
+    // response is walked as it's received, so it doesn't have to fit into memory
+    SignalKTreeWalker walker([this, &posted](const SignalKDeltaValue_t &value)
+                             {
+                                 SignalKUpdate_t update;
+                                 update.path_id = SignalKPathIndex::find(value.path, value.path_len);
+
+                                 // paths which already got a delta have newer value than snapshot
+                                 if (update.path_id != SK_PATH_ID_NONE && mark_path_received(update.path_id))
+                                 {
+                                     update.timestamp = millis();
+                                     if (post_value_update(update, value.value, value.value_len))
+                                     {
+                                         posted++;
+                                     }
+                                 }
+                             });
+
+    JsonHttpRequest request(url, token.c_str());
+    auto result = request.get([&walker, &length](const char *data, int len) -> bool
+                              {
+                                  length += len;
+                                  return walker.feed(data, len);
+                              });
+
+    if (result && walker.is_complete())
+    {
+        ESP_LOGI(WS_TAG, "Snapshot with %d bytes and %d values (%d too large) posted %d values in %d ms", length, walker.get_value_count(),
+                 walker.get_skipped_count(), posted, (int)((esp_timer_get_time() - start) / 1000));
+    }
+    else
+    {
+        ESP_LOGW(WS_TAG, "Snapshot download from %s failed (%d bytes received, %d values posted)!", url, length, posted);
+    }
+}
+
+/**
+ * Starts measurement of time to first complete view - paths of visible view (and global ones) are marked
+ * and measurement stops when all of them got first value from delta or snapshot.
+ */
+void SignalKSocket::start_view_measurement()
+{
+    uint32_t viewPaths[SK_PATH_BITSET_WORDS] = {0};
+    bool hasPaths = false;
+    int view = active_view_;
+
+    xSemaphoreTake(subscriptions_lock_, portMAX_DELAY);
+    for (auto subscription : subscriptions)
+    {
+        if (subscription.second->is_global() || subscription.second->is_in_view(view))
+        {
+            auto pathId = SignalKPathIndex::find(subscription.first.c_str(), subscription.first.length());
+            if (pathId != SK_PATH_ID_NONE)
+            {
+                viewPaths[pathId / 32] |= 1u << (pathId % 32);
+                hasPaths = true;
+            }
+        }
+    }
+    xSemaphoreGive(subscriptions_lock_);
+
+    portENTER_CRITICAL(&received_paths_lock_);
+    memcpy(view_paths_, viewPaths, sizeof(view_paths_));
+    memset(received_paths_, 0, sizeof(received_paths_));
+    time_to_complete_view_ms_ = 0;
+    measuring_view_ = hasPaths;
+    connected_time_us_ = esp_timer_get_time();
+    portEXIT_CRITICAL(&received_paths_lock_);
+}
+
+/// Marks path as received since connection, returns false if path already got a value before
+bool SignalKSocket::mark_path_received(sk_path_id_t path_id)
+{
+    uint32_t mask = 1u << (path_id % 32);
+    bool complete;
+    bool ret;
+
+    portENTER_CRITICAL(&received_paths_lock_);
+    complete = measuring_view_;
+    ret = (received_paths_[path_id / 32] & mask) == 0;
+    received_paths_[path_id / 32] |= mask;
+
+    if (ret && complete)
+    {
+        for (int i = 0; i < SK_PATH_BITSET_WORDS; i++)
+        {
+            if ((view_paths_[i] & ~received_paths_[i]) != 0)
+            {
+                complete = false;
+                break;
+            }
+        }
+
+        if (complete)
+        {
+            time_to_complete_view_ms_ = (uint32_t)((esp_timer_get_time() - connected_time_us_) / 1000);
+            measuring_view_ = false;
+        }
+    }
+    portEXIT_CRITICAL(&received_paths_lock_);
+
+    if (ret && complete)
+    {
+        ESP_LOGI(WS_TAG, "First complete view after %d ms (snapshot=%d)", time_to_complete_view_ms_, snapshot_enabled_);
+    }
+
+    return ret;
+}
+
+void SignalKSocket::parse_message(int length, const char *data)
+{
+    DynamicJsonDocument doc(1024);
 
     auto result = deserializeJson(doc, data, length);
     if (result.code() == DeserializationError::Ok)
@@ -293,7 +665,11 @@ void SignalKSocket::parse_data(int length, const char *data)
 
             messageType = "Request status";
 
-            if (requestState == "COMPLETED" && doc.containsKey("accessRequest"))
+            if (put_tracker_.handle_response(doc["requestId"].as<const char *>(), requestState.c_str(), doc["statusCode"] | 0))
+            {
+                messageType = "PUT response";
+            }
+            else if (requestState == "COMPLETED" && doc.containsKey("accessRequest"))
             {
                 messageType = "Access request";
                 JsonObject accessRequest = doc["accessRequest"].as<JsonObject>();
@@ -301,7 +677,8 @@ void SignalKSocket::parse_data(int length, const char *data)
                 ESP_LOGI(WS_TAG, "Got token request response with status %s from server!", permission.c_str());
                 if (permission == "APPROVED")
                 {
-                    token = accessRequest["token"].as<String>();
+                    // token is valid only for server which issued it
+                    reconnect_.set_token(current_server_, accessRequest["token"].as<String>());
                     token_request_pending = false;
                     pending_token_request_id = "";
                     update_subscriptions(); // update subscriptions
@@ -313,54 +690,6 @@ void SignalKSocket::parse_data(int length, const char *data)
                 }
             }
         }
-        else if (doc.containsKey("updates"))
-        {
-            messageType = "Delta";
-            delta_counter++;
-            JsonArray updates = doc["updates"].as<JsonArray>();
-
-            for (int i = 0; i < updates.size(); i++)
-            {
-                JsonObject update = updates[i].as<JsonObject>();
-                JsonObject source = update["source"].as<JsonObject>();
-                String sourceName = source["label"].as<String>();
-                JsonArray values = update["values"].as<JsonArray>();
-                for (int v = 0; v < values.size(); v++)
-                {
-                    JsonObject value = values[i].as<JsonObject>();
-                    String path = value["path"].as<String>();
-
-                    if (path.startsWith("notifications."))
-                    {
-                        bool active = is_notification_active(path);
-                        JsonObject notification = value["value"];
-                        String state = notification["state"].as<String>();
-                        ESP_LOGI(WS_TAG, "Got SK notification %s with state %s, active=%d", path.c_str(), state.c_str(), active);
-
-                        if (state == "alarm" || state == "alert" || state == "warn" || state == "emergency") // alarm is active we need to wake up the watch and show alert text on the display
-                        {
-                            if (!active)
-                            {
-                                String message = notification["message"];
-                                post_gui_warning(message);
-                                activeNotifications.push_back(path);
-                            }
-                        }
-                        else
-                        {
-                            remove_active_notification(path);
-                        }
-                    }
-                    else if (!is_low_power())
-                    {
-                        ESP_LOGI(WS_TAG, "Got SK value update %s", path.c_str());
-                        String json;
-                        serializeJson(value, json);
-                        post_gui_sk_dv_update(json);
-                    }
-                }
-            }
-        }
         else if (doc.containsKey("timestamp"))
         {
             if (sync_time_with_server)
@@ -396,24 +725,201 @@ void SignalKSocket::notify_change(const WifiState_t &wifiState)
     }
     else if (wifiState == WifiState_t::Wifi_Disconnected || wifiState == WifiState_t::Wifi_Off)
     {
-        // just make reconnect counter = 0
-        reconnect_counter_ = 0;
+        // socket is connected again by Wifi_Connected
+        xTimerStop(reconnect_timer_, 0);
+        reconnect_.reset();
+    }
+}
+
+void SignalKSocket::schedule_reconnect()
+{
+    auto delay = reconnect_.on_disconnected(is_low_power());
+
+    if (reconnect_.get_current_attempt() == SK_RECONNECT_WARN_ATTEMPTS)
+    {
+        post_gui_warning(GuiMessageCode_t::GUI_WARN_SK_LOST_CONNECTION);
+    }
+
+    ESP_LOGI(WS_TAG, "Reconnecting in %u ms (attempt %d)", delay, reconnect_.get_current_attempt() + 1);
+    // changing period starts the timer
+    xTimerChangePeriod(reconnect_timer_, pdMS_TO_TICKS(delay), 0);
+}
+
+void SignalKSocket::reconnect_timer_callback(TimerHandle_t timer)
+{
+    auto socket = (SignalKSocket *)pvTimerGetTimerID(timer);
+    // timer task can't block, client is destroyed and created in async dispatcher
+    twatchsk::run_async("SK reconnect", [socket]()
+                        { socket->reconnect_attempt(); });
+}
+
+void SignalKSocket::reconnect_attempt()
+{
+    if (!reconnect_.is_reconnecting() || value != WebsocketState_t::WS_Offline)
+    {
+        return;
+    }
+
+    if (!wifi->is_connected())
+    {
+        reconnect_.reset();
+        return;
+    }
+
+    auto target = reconnect_.next_target();
+    if (!connect_to(target.address, target.port, target.server, target.cached_ip))
+    {
+        schedule_reconnect();
     }
 }
 
-void SignalKSocket::send_json(const JsonObject &json)
+void SignalKSocket::liveness_timer_callback(TimerHandle_t timer)
+{
+    auto socket = (SignalKSocket *)pvTimerGetTimerID(timer);
+    socket->check_liveness();
+}
+
+bool SignalKSocket::is_connection_dead()
 {
-    static char buff[1024];
+    return value == WebsocketState_t::WS_Connected && !keepalive_.is_alive(esp_timer_get_time());
+}
+
+void SignalKSocket::check_liveness()
+{
+    // the check is cheap and runs on the caller's task (timer, low power scheduler), only dead connection is handed over
+    if (!is_connection_dead())
+    {
+        return;
+    }
+
+    // destroying the client waits for websocket task, so it's done in async dispatcher
+    twatchsk::run_async("SK dead", [this]()
+                        {
+                            // check again, connection could have been replaced meanwhile
+                            if (is_connection_dead())
+                            {
+                                // server or network vanished without closing TCP connection, client wouldn't notice it for minutes
+                                ESP_LOGW(WS_TAG, "Connection is dead, reconnecting.");
+                                destroy_client();
+                                schedule_reconnect();
+                            }
+                        });
+}
+
+void SignalKSocket::resolve_server_ip(int server, const String &host)
+{
+    struct in_addr address;
+
+    if (server < 0 || inet_aton(host.c_str(), &address))
+    {
+        return;
+    }
+
+    twatchsk::run_async("SK resolve", [this, server, host]()
+                        {
+                            struct addrinfo hints;
+                            struct addrinfo *result = NULL;
+                            memset(&hints, 0, sizeof(hints));
+                            hints.ai_family = AF_INET;
+                            hints.ai_socktype = SOCK_STREAM;
+
+                            // name was just resolved by websocket client, so it's answered from DNS cache
+                            if (getaddrinfo(host.c_str(), NULL, &hints, &result) == 0 && result != NULL)
+                            {
+                                char ip[16];
+                                inet_ntoa_r(((struct sockaddr_in *)result->ai_addr)->sin_addr, ip, sizeof(ip));
+                                freeaddrinfo(result);
+                                ESP_LOGI(WS_TAG, "Server %s resolved to %s", host.c_str(), ip);
+
+                                if (reconnect_.set_last_ip(server, ip))
+                                {
+                                    save();
+                                }
+                            }
+                            else
+                            {
+                                ESP_LOGW(WS_TAG, "Unable to resolve %s", host.c_str());
+                            }
+                        });
+}
+
+void SignalKSocket::add_known_server(const String &host, int port)
+{
+    if (reconnect_.add_server(host, port))
+    {
+        save();
+    }
+}
+
+void SignalKSocket::send_json(const JsonObject &json, OutboundPriority_t priority, uint32_t timeout_ms)
+{
+    char buff[1024];
     size_t len = serializeJson(json, buff);
     ESP_LOGI(WS_TAG, "Sending json payload=%s", buff);
-    esp_websocket_client_send_text(websocket, buff, len, portMAX_DELAY);
+    send_text(buff, len, priority, timeout_ms);
+}
+
+bool SignalKSocket::send_text(const char *text, int length, OutboundPriority_t priority, uint32_t timeout_ms,
+                              OutboundMergeKey_t merge_key, send_callback callback)
+{
+    return outbound_.push(text, length, priority, merge_key, timeout_ms, callback);
+}
+
+/// Sends queued messages, so slow or stalled server blocks only this task and never the GUI
+void SignalKSocket::sender_task(void *arg)
+{
+    SignalKSocket *socket = (SignalKSocket *)arg;
+
+    while (true)
+    {
+        auto message = socket->outbound_.pop(portMAX_DELAY);
+        if (message == NULL)
+        {
+            continue;
+        }
+
+        bool sent = false;
+        esp_websocket_client_handle_t client = NULL;
+        xSemaphoreTake(socket->websocket_lock_, portMAX_DELAY);
+        if (socket->websocket_initialized && socket->websocket != NULL && esp_websocket_client_is_connected(socket->websocket))
+        {
+            client = socket->websocket;
+            socket->sending_ = true;
+        }
+        xSemaphoreGive(socket->websocket_lock_);
+
+        // slow send doesn't hold the lock, so keepalive changes and disconnect aren't stuck behind it
+        if (client != NULL)
+        {
+            int32_t timeout = (int32_t)(message->deadline - millis());
+            if (timeout < WS_SEND_MIN_TIMEOUT)
+            {
+                timeout = WS_SEND_MIN_TIMEOUT;
+            }
+
+            auto result = esp_websocket_client_send_text(client, message->text, message->length, timeout / portTICK_PERIOD_MS);
+            if (result > 0)
+            {
+                socket->tx_bytes_ += result;
+                sent = true;
+            }
+            else
+            {
+                ESP_LOGW(WS_TAG, "Unable to send message with priority %d (result=%d)", (int)message->priority, result);
+            }
+            socket->sending_ = false;
+        }
+
+        WebsocketOutboundQueue::complete(message, sent);
+    }
 }
 
 void SignalKSocket::send_token_permission()
 {
-    String requestId = UUID::new_id();
+    char requestId[REQUEST_ID_STR_LEN];
+    twatchsk::new_request_id(requestId);
 
-    ESP_LOGI(WS_TAG, "Requesting SignalK access token RequestId=%s...", requestId.c_str());
+    ESP_LOGI(WS_TAG, "Requesting SignalK access token RequestId=%s...", requestId);
     token_request_pending = true;
     pending_token_request_id = requestId;
     StaticJsonDocument<256> requestJson;
@@ -429,22 +935,31 @@ void SignalKSocket::send_token_permission()
         accessRequest["description"] = device_name_;
     }
     accessRequest["permissions"] = "admin";
-    send_json(requestJson.as<JsonObject>());
+    send_json(requestJson.as<JsonObject>(), WS_PRIORITY_HIGH, WS_SEND_TIMEOUT_HIGH);
 }
 
-SignalKSubscription *SignalKSocket::add_subscription(String path, uint period, bool is_low_power)
+void SignalKSocket::add_subscription(String path, uint period, bool is_low_power, int view, SubscriptionPolicy_t policy, uint min_period)
 {
+    xSemaphoreTake(subscriptions_lock_, portMAX_DELAY);
+    SignalKSubscription *subscription;
     auto iterator = subscriptions.find(path);
     if (iterator != subscriptions.end())
     {
-        return iterator->second;
+        subscription = iterator->second;
+        subscription->merge_period(period);
     }
     else
     {
-        auto newSubscription = new SignalKSubscription(path, period, is_low_power);
-        subscriptions[path] = newSubscription;
-        return newSubscription;
+        subscription = new SignalKSubscription(path, period, is_low_power);
+        subscriptions[path] = subscription;
     }
+
+    if (view >= 0)
+    {
+        subscription->add_view(view);
+    }
+    subscription->merge_policy(policy, min_period);
+    xSemaphoreGive(subscriptions_lock_);
 }
 
 void SignalKSocket::update_subscriptions(bool force)
@@ -452,39 +967,74 @@ void SignalKSocket::update_subscriptions(bool force)
     if (value == WebsocketState_t::WS_Connected && !token_request_pending)
     {
         bool is_lp = xEventGroupGetBits(g_app_state) & G_APP_STATE_LOW_POWER;
-        if (force || is_lp || (low_power_subscriptions_ == true && !is_lp))
-        {
-            low_power_subscriptions_ = is_lp;
-            DynamicJsonDocument subscriptionsJson(subscriptions.size() * 100);
-            int count = 0;
-            subscriptionsJson["context"] = "vessels.self";
-            JsonArray subscribe = subscriptionsJson.createNestedArray("subscribe");
-            for (auto subscription : this->subscriptions)
+
+        xSemaphoreTake(subscriptions_lock_, portMAX_DELAY);
+        if (force)
+        {
+            // stream is opened with subscribe=none, so server has no subscriptions of this client
+            for (auto subscription : subscriptions)
             {
-                if (!is_lp || (is_lp && subscription.second->get_low_power()))
-                {
-                    count++;
-                    String path = subscription.second->get_path();
-                    uint period = subscription.second->get_period();
-                    JsonObject subscribePath = subscribe.createNestedObject();
-
-                    subscribePath["path"] = path;
-                    subscribePath["period"] = period;
-                    ESP_LOGI(WS_TAG, "Adding %s subscription with listen_delay %d ms", path.c_str(), period);
-                }
+                subscription.second->set_active_period(0);
             }
+            resync_subscriptions_ = false;
+        }
 
-            esp_websocket_client_send_text(websocket, UnsubscribeMessage, strlen(UnsubscribeMessage), portMAX_DELAY);
+        low_power_subscriptions_ = is_lp;
+        send_subscription_changes(is_lp);
+        xSemaphoreGive(subscriptions_lock_);
+    }
+}
 
-            if (count > 0)
-            {
-                String subscriptionMessage;
-                serializeJson(subscriptionsJson, subscriptionMessage);
-                // ESP_LOGI(WS_TAG, "Subscription: %s", subscriptionMessage.c_str());
-                esp_websocket_client_send_text(websocket, subscriptionMessage.c_str(), subscriptionMessage.length(), portMAX_DELAY);
-            }
+/**
+ * Sends only subscription changes, see SignalKSubscriptionPlan. Caller holds subscriptions lock.
+ * Active periods are updated before messages are sent, if any of them is dropped or expires in outbound queue,
+ * next update unsubscribes everything and subscribes the whole desired set.
+ */
+void SignalKSocket::send_subscription_changes(bool is_lp)
+{
+    SignalKSubscriptionPlan plan;
+    auto on_sent = [this](bool sent)
+    {
+        if (!sent && !resync_subscriptions_.exchange(true))
+        {
+            ESP_LOGW(WS_TAG, "Subscription message wasn't sent, subscriptions will be sent again.");
+        }
+    };
+
+    if (plan.build(subscriptions, is_lp, active_view_, background_period_, resync_subscriptions_.exchange(false)))
+    {
+        if (plan.get_unsubscribe_all())
+        {
+            send_text(SK_UNSUBSCRIBE_ALL, strlen(SK_UNSUBSCRIBE_ALL), WS_PRIORITY_NORMAL, WS_SEND_TIMEOUT_NORMAL, WS_MERGE_NONE, on_sent);
+        }
+
+        // messages of the same priority are sent in order, so subscribe always follows unsubscribe
+        auto &message = plan.get_subscribe_message();
+        if (message.length() > 0)
+        {
+            send_text(message.c_str(), message.length(), WS_PRIORITY_NORMAL, WS_SEND_TIMEOUT_NORMAL, WS_MERGE_NONE, on_sent);
         }
     }
+
+    ESP_LOGI(WS_TAG, "Subscription changes: unsubscribed=%d (all=%d), subscribed=%d", plan.get_unsubscribed_count(),
+             (int)plan.get_unsubscribe_all(), plan.get_subscribed_count());
+}
+
+void SignalKSocket::set_active_view(int view)
+{
+    if (active_view_.exchange(view) != view)
+    {
+        // it's called from LVGL task, subscription changes are built and queued in background
+        twatchsk::run_async("SK view", [this]()
+                            {
+                                if (value == WebsocketState_t::WS_Connected && !token_request_pending && !is_low_power())
+                                {
+                                    xSemaphoreTake(subscriptions_lock_, portMAX_DELAY);
+                                    send_subscription_changes(false);
+                                    xSemaphoreGive(subscriptions_lock_);
+                                }
+                            });
+    }
 }
 
 bool SignalKSocket::is_notification_active(String path)
@@ -513,13 +1063,6 @@ void SignalKSocket::remove_active_notification(String path)
     }
 }
 
-/// This is kind of HACK to control period 10 seconds ping of websocket - we need to avoid it to save some battery
-void update_ws_timeout(esp_websocket_client_info *client)
-{
-    // ESP_LOGI(WS_TAG, "Ping timeout %d ms", (int)((esp_timer_get_time() / 1000) - client->ping_tick_ms));
-    client->ping_tick_ms = esp_timer_get_time() / 1000;
-}
-
 void SignalKSocket::send_status_message()
 {
     StaticJsonDocument<512> statusJson;
@@ -558,31 +1101,67 @@ void SignalKSocket::send_status_message()
     if (serializeJson(statusJson, buff))
     {
         ESP_LOGI(WS_TAG, "Status json: %s", buff);
-        esp_websocket_client_send_text(websocket, buff, strlen(buff), portMAX_DELAY);
+        // status isn't important - it waits behind other messages and only the latest one is kept
+        send_text(buff, strlen(buff), WS_PRIORITY_LOW, WS_SEND_TIMEOUT_LOW, WS_MERGE_STATUS);
     }
 }
 
 void SignalKSocket::handle_power_event(PowerCode_t code, uint32_t arg)
 {
-    if (code == PowerCode_t::POWER_ENTER_LOW_POWER && !low_power_subscriptions_)
+    if (code == PowerCode_t::POWER_ENTER_LOW_POWER)
     {
-        update_subscriptions();
+        if (!low_power_subscriptions_)
+        {
+            update_subscriptions();
+        }
+        // timer would wake the CPU every few seconds, liveness is checked by low power job instead
+        xTimerStop(liveness_timer_, 0);
+        apply_keepalive(true);
     }
-    else if (code == PowerCode_t::POWER_LOW_TICK)
+    else if (code == PowerCode_t::POWER_LEAVE_LOW_POWER)
     {
-        // we need to avoid client ping for now
-        if (value == WebsocketState_t::WS_Connected)
+        apply_keepalive(false);
+        // deltas were dropped in low power, so values on the screen are old
+        if (value == WebsocketState_t::WS_Connected && !token_request_pending)
         {
-            update_ws_timeout((esp_websocket_client_info *)websocket);
-            // send status message every minute in low power mode
-            if (arg % 60 == 0)
-            {
-                send_status_message();
-            }
+            start_view_measurement();
+            request_snapshot();
         }
     }
 }
 
+void SignalKSocket::apply_keepalive(bool low_power)
+{
+    xSemaphoreTake(websocket_lock_, portMAX_DELAY);
+    if (websocket_initialized && websocket != NULL)
+    {
+        keepalive_.apply(websocket, low_power);
+        keepalive_.on_received(esp_timer_get_time()); // liveness timeout changes with power mode, start counting again
+    }
+    xSemaphoreGive(websocket_lock_);
+
+    if (!low_power && value == WebsocketState_t::WS_Connected)
+    {
+        xTimerStart(liveness_timer_, 0);
+    }
+}
+
+void SignalKSocket::register_low_power_jobs(LowPowerScheduler &scheduler)
+{
+    // dead connection is detected late in low power, but it saves wake ups
+    // jobs run inline, so the scheduler measures their work (reconnecting dead connection is dispatched)
+    scheduler.add_job("ws liveness", 30000, 30000, POWER_CLASS_CPU, [this]()
+                      { check_liveness(); });
+    // status message every minute in low power mode, it's only queued (sender task transmits it with other messages)
+    scheduler.add_job("sk status", 60000, 15000, POWER_CLASS_CPU, [this]()
+                      {
+                          if (value == WebsocketState_t::WS_Connected)
+                          {
+                              send_status_message();
+                          }
+                      });
+}
+
 bool SignalKSocket::reconnect()
 {
     auto ret = false;
@@ -606,21 +1185,46 @@ bool SignalKSocket::reconnect()
 
 void SignalKSocket::clear_token()
 {
-    token = "";
+    reconnect_.clear_tokens();
     save();
 }
 
-bool SignalKSocket::send_put_request(JsonObject &request)
+bool SignalKSocket::send_put_request(JsonObject &request, put_callback callback)
 {
     char buff[1024];
 
     if (serializeJson(request, buff))
     {
-        ESP_LOGI(WS_TAG, "Sending put json(len=%d): %s", strlen(buff), buff);
-        return esp_websocket_client_send_text(websocket, buff, strlen(buff), portMAX_DELAY) > 0;
+        return send_put_request(buff, strlen(buff), request["requestId"].as<const char *>(), callback);
     }
     else
     {
         return false;
     }
+}
+
+bool SignalKSocket::send_put_request(const char *text, int length, const char *request_id, put_callback callback)
+{
+    ESP_LOGI(WS_TAG, "Sending put json(len=%d): %.*s", length, length, text);
+
+    if (request_id == NULL || !put_tracker_.add(request_id, callback))
+    {
+        return false;
+    }
+
+    String requestId(request_id);
+    auto queued = send_text(text, length, WS_PRIORITY_HIGH, WS_SEND_TIMEOUT_HIGH, WS_MERGE_NONE, [this, requestId](bool sent)
+                            {
+                                if (!sent)
+                                {
+                                    put_tracker_.handle_not_sent(requestId.c_str());
+                                }
+                            });
+    if (!queued)
+    {
+        // caller handles the failure itself, so callback isn't invoked later
+        put_tracker_.remove(request_id);
+    }
+
+    return queued;
 }
\ No newline at end of file
@@ -1,16 +1,39 @@
 #pragma once
 #include "ArduinoJson.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/timers.h>
 #include "esp_websocket_client.h"
 #include "vector"
 #include "functional"
 #include "map"
+#include <atomic>
 #include "system/configurable.h"
 #include "system/systemobject.h"
 #include "system/observable.h"
 #include "hardware/Wifi.h"
 #include "networking/signalk_subscription.h"
+#include "networking/signalk_subscription_plan.h"
+#include "networking/signalk_delta_parser.h"
+#include "networking/signalk_tree_walker.h"
+#include "networking/ws_frame_assembler.h"
+#include "networking/signalk_path_index.h"
+#include "networking/signalk_capture.h"
+#include "networking/ws_outbound_queue.h"
+#include "networking/signalk_put_tracker.h"
+#include "networking/signalk_put_template.h"
+#include "networking/signalk_frame_filter.h"
+#include "networking/reconnect_scheduler.h"
+#include "networking/ws_keepalive.h"
+#include "system/pipeline_stats.h"
 #include "hardware/hardware.h"
 
+#define WS_SEND_TIMEOUT_HIGH 5000    // ms PUT / access request can wait in outbound queue and for the socket
+#define WS_SEND_TIMEOUT_NORMAL 10000 // ms for subscription changes
+#define WS_SEND_TIMEOUT_LOW 30000    // ms for telemetry
+#define WS_SEND_MIN_TIMEOUT 100      // ms the sender waits for the socket even if message deadline is closer
+#define SK_RECONNECT_WARN_ATTEMPTS 3  // failed reconnect attempts before user is told that connection is lost
+#define SK_PATH_BITSET_WORDS ((SK_PATH_INDEX_MAX + 31) / 32)
+
 enum WebsocketState_t
 {
     WS_Offline = 0,
@@ -26,7 +49,8 @@ public:
     bool disconnect();
     bool reconnect();
     void clear_token();
-    void parse_data(int length, const char *data);
+    /// Parses complete websocket message, stage is STAGE_PARSE (websocket task) or STAGE_REPLAY (replay task)
+    void parse_data(int length, const char *data, PipelineStage_t stage = STAGE_PARSE);
     esp_websocket_client_handle_t get_ws() { return websocket; }
     void update_status(WebsocketState_t status)
     {
@@ -40,14 +64,47 @@ public:
     bool get_sync_time_with_server() { return sync_time_with_server; }
     void set_sync_time_with_server(bool enabled) { sync_time_with_server = enabled; }
     uint get_handled_delta_count() { return delta_counter; }
-    SignalKSubscription *add_subscription(String path, uint period, bool is_low_power);
+    uint32_t get_tx_bytes() { return tx_bytes_; }
+    uint32_t get_rx_bytes() { return rx_bytes_; }
+    uint get_dropped_frame_count() { return frame_assembler_.get_dropped_oversize_count() + frame_assembler_.get_dropped_incomplete_count(); }
+    /**
+     * Adds path to subscriptions (or merges period, view and policy with existing subscription of the path).
+     * It can be called from any task, subscriptions are guarded by a lock.
+     * */
+    void add_subscription(String path, uint period, bool is_low_power, int view = -1,
+                          SubscriptionPolicy_t policy = SK_POLICY_DEFAULT, uint min_period = 0);
     /**
      *  Updates subscriptions depending on power mode to reduce power drain in low power mode.
      *  In low power mode only active subscription is notifications.*
+     *  Only differences against subscriptions on the server are sent, force means server state is unknown (new connection).
      * */
     void update_subscriptions(bool force = false);
+    /**
+     * Sets index of dynamic view that is visible (-1 = watch face). Paths of visible view are subscribed with their period,
+     * paths of hidden views with background period (or not at all if background period is 0).
+     * */
+    void set_active_view(int view);
+    /**
+     * Downloads full data model of vessels.self over REST API (in background task) and posts values of bound paths
+     * to GUI, so views are filled without waiting for first delta of every path.
+     * */
+    void request_snapshot();
+    bool get_snapshot_enabled() { return snapshot_enabled_; }
+    void set_snapshot_enabled(bool enabled) { snapshot_enabled_ = enabled; }
+    SignalKFrameFilter &get_frame_filter() { return frame_filter_; }
+    ///Returns time in ms between connection and moment when all paths of visible view got a value (0 = not complete yet)
+    uint32_t get_time_to_complete_view() { return time_to_complete_view_ms_; }
+    /**
+     * Replays recorded websocket messages (see "capture" config) into parser if "replay" config is set,
+     * latency stats of the pipeline are logged when replay is finished.
+     * */
+    bool start_replay();
+    uint get_background_period() { return background_period_; }
+    void set_background_period(uint period) { background_period_ = period; }
     ///This is intended to be wired with Hardware class power events
     void handle_power_event(PowerCode_t code, uint32_t arg);
+    ///Registers jobs that run periodically while the watch sleeps (status message, liveness check)
+    void register_low_power_jobs(LowPowerScheduler &scheduler);
     ///Updates server configuration (address and port)
     void set_server(String server_address, int port)
     {
@@ -60,37 +117,102 @@ public:
         device_name_ = device_name_ptr;
     }
 
+    /// Returns token issued by configured (primary) server
     String get_token()
     {
-        return token;
+        return reconnect_.get_token(0);
     }
     
-    bool send_put_request(JsonObject& request);
+    /**
+     * Queues PUT request and tracks its response by requestId. Callback (if set) is invoked on GUI task
+     * when server completes the request, or when it couldn't be sent or timed out.
+     * */
+    bool send_put_request(JsonObject& request, put_callback callback = nullptr);
+    /// Queues already serialized PUT request (see SignalKPutTemplate), request_id must be the one in the text
+    bool send_put_request(const char *text, int length, const char *request_id, put_callback callback = nullptr);
+    ///Handles finished and timed out PUT requests, it has to be called periodically from GUI task
+    void process_put_requests() { put_tracker_.process(); }
+    SignalKPutTracker &get_put_tracker() { return put_tracker_; }
+    uint32_t get_outbound_dropped_count() { return outbound_.get_dropped_count() + outbound_.get_expired_count(); }
+    /// Adds alternative server used when connection to the current one is lost (e.g. found by mDNS)
+    void add_known_server(const String &host, int port);
+    ReconnectScheduler &get_reconnect_scheduler() { return reconnect_; }
+    WebsocketKeepalive &get_keepalive() { return keepalive_; }
 private:
-    const int reconnect_count_ = 3;
     static void ws_event_handler(void *arg, esp_event_base_t event_base,
                                  int32_t event_id, void *event_data);
     const char *device_name_ = NULL;
     String server = "";
     int port = 0;
     uint delta_counter = 0;
+    uint32_t tx_bytes_ = 0;
+    uint32_t rx_bytes_ = 0;
     bool sync_time_with_server = false;
-    String token = "";
     String clientId = "";
     bool token_request_pending = false;
     String pending_token_request_id = "";
     esp_websocket_client_handle_t websocket;
-    int reconnect_counter_ = reconnect_count_;
+    WebsocketOutboundQueue outbound_;
+    SignalKPutTracker put_tracker_;
+    SemaphoreHandle_t websocket_lock_; // guards websocket handle between sender task and connect / disconnect
+    std::atomic<bool> sending_{false}; // sender task uses websocket handle outside of the lock, it's not destroyed meanwhile
+    WebsocketFrameAssembler frame_assembler_;
+    ReconnectScheduler reconnect_;
+    TimerHandle_t reconnect_timer_;
+    WebsocketKeepalive keepalive_;
+    TimerHandle_t liveness_timer_;
+    std::atomic<int> current_server_{0}; // index of server in reconnect scheduler list the websocket connects to
+    bool current_cached_ip_ = false;
     bool websocket_initialized = false;
     bool low_power_subscriptions_ = false;
+    std::atomic<int> active_view_{-1};
+    std::atomic<bool> resync_subscriptions_{false}; // subscription message wasn't sent, server state is unknown
+    uint background_period_ = 0;
+    bool snapshot_enabled_ = true;
+    std::atomic<bool> snapshot_pending_{false};
+    bool prefilter_enabled_ = true;
+    SignalKFrameFilter frame_filter_;
+    int64_t connected_time_us_ = 0;
+    uint32_t time_to_complete_view_ms_ = 0;
+    bool measuring_view_ = false;
+    bool capture_enabled_ = false;
+    ReplayMode_t replay_mode_ = REPLAY_OFF;
+    SignalKCapture capture_;
+    uint32_t received_paths_[SK_PATH_BITSET_WORDS] = {0};
+    uint32_t view_paths_[SK_PATH_BITSET_WORDS] = {0};
+    portMUX_TYPE received_paths_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    SemaphoreHandle_t subscriptions_lock_; // guards subscriptions and their active periods (GUI, websocket, async tasks)
     std::map<String, SignalKSubscription *> subscriptions;
     std::vector<String> activeNotifications;
     WifiManager *wifi;
+    bool connect_to(const String &address, int port, int server, bool cached_ip);
+    bool destroy_client();
+    void schedule_reconnect();
+    void reconnect_attempt();
+    void resolve_server_ip(int server, const String &host);
+    static void reconnect_timer_callback(TimerHandle_t timer);
+    static void liveness_timer_callback(TimerHandle_t timer);
+    /// Connected, but nothing was received from server for too long
+    bool is_connection_dead();
+    /// Checks liveness on the caller's task, dead connection is destroyed and reconnected from async dispatcher
+    void check_liveness();
+    /// Sets ping interval of running client for given power mode
+    void apply_keepalive(bool low_power);
     void load_config_from_file(const JsonObject &json) override;
     void save_config_to_file(JsonObject &json) override;
     void send_token_permission();
-    void send_json(const JsonObject &json);
+    void send_json(const JsonObject &json, OutboundPriority_t priority, uint32_t timeout_ms);
+    /// Queues message for sender task, it never blocks the caller
+    bool send_text(const char *text, int length, OutboundPriority_t priority, uint32_t timeout_ms,
+                   OutboundMergeKey_t merge_key = WS_MERGE_NONE, send_callback callback = nullptr);
+    static void sender_task(void *arg);
     bool is_notification_active(String path);
     void remove_active_notification(String path);
     void send_status_message();
+    void send_subscription_changes(bool is_lp);
+    void handle_delta_value(const SignalKDeltaValue_t &value, bool low_power);
+    void parse_message(int length, const char *data);
+    void fetch_snapshot(const String &address, int port, const String &token);
+    void start_view_measurement();
+    bool mark_path_received(sk_path_id_t path_id);
 };
\ No newline at end of file
@@ -1,5 +1,15 @@
 #pragma once
 #include "Arduino.h"
+#include <vector>
+
+/// SignalK subscription policy (see SignalK subscription protocol), default means it isn't sent and server decides
+enum SubscriptionPolicy_t
+{
+    SK_POLICY_DEFAULT,
+    SK_POLICY_INSTANT,
+    SK_POLICY_IDEAL,
+    SK_POLICY_FIXED
+};
 
 class SignalKSubscription
 {
@@ -13,11 +23,96 @@ class SignalKSubscription
         bool get_low_power() { return is_low_power_; }
         String get_path() { return path_; }
         uint get_period() { return period_; }
+        /// When path is bound in multiple places, the fastest period is used
+        void merge_period(uint period)
+        {
+            if (period < period_)
+            {
+                period_ = period;
+            }
+        }
+        SubscriptionPolicy_t get_policy() { return policy_; }
+        uint get_min_period() { return min_period_; }
+        /// Policy is set by the first binding that defines it, the shortest minimum period wins
+        void merge_policy(SubscriptionPolicy_t policy, uint min_period)
+        {
+            if (policy_ == SK_POLICY_DEFAULT)
+            {
+                policy_ = policy;
+            }
+
+            if (min_period > 0 && (min_period_ == 0 || min_period < min_period_))
+            {
+                min_period_ = min_period;
+            }
+        }
+        static const char *policy_to_string(SubscriptionPolicy_t policy)
+        {
+            switch (policy)
+            {
+            case SK_POLICY_INSTANT:
+                return "instant";
+            case SK_POLICY_IDEAL:
+                return "ideal";
+            case SK_POLICY_FIXED:
+                return "fixed";
+            default:
+                return NULL;
+            }
+        }
+        static SubscriptionPolicy_t policy_from_string(const String &policy)
+        {
+            if (policy == "instant")
+            {
+                return SK_POLICY_INSTANT;
+            }
+            else if (policy == "ideal")
+            {
+                return SK_POLICY_IDEAL;
+            }
+            else if (policy == "fixed")
+            {
+                return SK_POLICY_FIXED;
+            }
+
+            return SK_POLICY_DEFAULT;
+        }
         bool get_active() { return is_active_; }
         void set_active(bool value) { is_active_ = value; }
+        /// Period the path is currently subscribed with on the server (0 = not subscribed)
+        uint get_active_period() { return active_period_; }
+        void set_active_period(uint period)
+        {
+            active_period_ = period;
+            is_active_ = period > 0;
+        }
+        void add_view(int view)
+        {
+            if (!is_in_view(view))
+            {
+                views_.push_back(view);
+            }
+        }
+        bool is_in_view(int view)
+        {
+            for (int v : views_)
+            {
+                if (v == view)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+        /// Global subscriptions (notifications, system paths) aren't bound to any view and are always subscribed
+        bool is_global() { return views_.empty(); }
     private:
         String path_ = "";
         uint period_ = 1000;
+        uint active_period_ = 0;
+        uint min_period_ = 0;
+        SubscriptionPolicy_t policy_ = SK_POLICY_DEFAULT;
         bool is_low_power_ = false;
         bool is_active_ = false;
-};
\ No newline at end of file
+        std::vector<int> views_;
+};
@@ -0,0 +1,105 @@
+#include "signalk_subscription_plan.h"
+#include <stdio.h>
+
+uint SignalKSubscriptionPlan::get_desired_period(SignalKSubscription *subscription, bool is_lp, int view, uint background_period)
+{
+    uint ret = 0;
+
+    if (is_lp)
+    {
+        ret = subscription->get_low_power() ? subscription->get_period() : 0;
+    }
+    else if (subscription->is_global() || subscription->is_in_view(view))
+    {
+        ret = subscription->get_period();
+    }
+    else if (background_period > 0)
+    {
+        // paths of hidden views are refreshed slowly (never faster than configured period)
+        ret = background_period > subscription->get_period() ? background_period : subscription->get_period();
+    }
+
+    return ret;
+}
+
+bool SignalKSubscriptionPlan::build(std::map<String, SignalKSubscription *> &subscriptions, bool is_lp, int view, uint background_period, bool resync)
+{
+    unsubscribe_all_ = resync;
+    subscribe_message_ = "";
+    subscribed_ = 0;
+    unsubscribed_ = 0;
+
+    for (auto subscription : subscriptions)
+    {
+        uint activePeriod = subscription.second->get_active_period();
+
+        if (!unsubscribe_all_ && activePeriod > 0 && get_desired_period(subscription.second, is_lp, view, background_period) != activePeriod)
+        {
+            // path can't be unsubscribed alone
+            unsubscribe_all_ = true;
+            break;
+        }
+    }
+
+    for (auto subscription : subscriptions)
+    {
+        uint period = get_desired_period(subscription.second, is_lp, view, background_period);
+        uint activePeriod = subscription.second->get_active_period();
+
+        if (unsubscribe_all_)
+        {
+            unsubscribed_ += activePeriod > 0 ? 1 : 0;
+            activePeriod = 0;
+        }
+
+        if (period > 0 && activePeriod == 0)
+        {
+            append_subscription(subscription.second, period);
+        }
+
+        subscription.second->set_active_period(period);
+    }
+
+    if (subscribed_ > 0)
+    {
+        subscribe_message_ += "]}";
+    }
+
+    return unsubscribe_all_ || subscribed_ > 0;
+}
+
+void SignalKSubscriptionPlan::append_subscription(SignalKSubscription *subscription, uint period)
+{
+    char buffer[96];
+
+    subscribe_message_ += subscribed_ == 0 ? "{\"context\":\"vessels.self\",\"subscribe\":[{\"path\":\"" : ",{\"path\":\"";
+    String path = subscription->get_path();
+    for (int i = 0; i < (int)path.length(); i++)
+    {
+        char c = path.c_str()[i];
+        if (c == '"' || c == '\\')
+        {
+            subscribe_message_ += '\\';
+        }
+        subscribe_message_ += c;
+    }
+
+    snprintf(buffer, sizeof(buffer), "\",\"period\":%u", period);
+    subscribe_message_ += buffer;
+
+    auto policy = SignalKSubscription::policy_to_string(subscription->get_policy());
+    if (policy != NULL)
+    {
+        snprintf(buffer, sizeof(buffer), ",\"policy\":\"%s\"", policy);
+        subscribe_message_ += buffer;
+    }
+
+    if (subscription->get_min_period() > 0)
+    {
+        snprintf(buffer, sizeof(buffer), ",\"minPeriod\":%u", subscription->get_min_period());
+        subscribe_message_ += buffer;
+    }
+
+    subscribe_message_ += "}";
+    subscribed_++;
+}
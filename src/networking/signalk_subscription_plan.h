@@ -0,0 +1,42 @@
+#pragma once
+#include <map>
+#include "Arduino.h"
+#include "networking/signalk_subscription.h"
+
+#define SK_UNSUBSCRIBE_ALL "{\"context\":\"*\",\"unsubscribe\":[{\"path\":\"*\"}]}"
+
+/**
+ * @brief Builds messages which bring subscriptions on the server to the desired state (it's part of host build).
+ * signalk-server honours only unsubscribe of all paths (SK_UNSUBSCRIBE_ALL) and it doesn't merge repeated subscriptions
+ * of the same path (every subscribe adds another one and values are sent for each of them). So if any path has to be
+ * removed or its period changes, everything is unsubscribed and the whole desired set is subscribed again.
+ * When paths are only added, just the new ones are subscribed.
+ **/
+class SignalKSubscriptionPlan
+{
+public:
+    /// Period the path should be subscribed with (0 = not subscribed)
+    static uint get_desired_period(SignalKSubscription *subscription, bool is_lp, int view, uint background_period);
+    /**
+     * @brief Compares desired periods with active ones (subscriptions on the server) and builds messages,
+     * subscriptions are marked with periods they will have on the server once the messages are sent
+     * @param resync active periods aren't trusted (previous message wasn't sent), everything is unsubscribed and
+     * the whole desired set is subscribed again
+     * @return true if any message has to be sent
+     **/
+    bool build(std::map<String, SignalKSubscription *> &subscriptions, bool is_lp, int view, uint background_period, bool resync = false);
+    /// SK_UNSUBSCRIBE_ALL has to be sent before subscribe message
+    bool get_unsubscribe_all() { return unsubscribe_all_; }
+    /// Empty if nothing has to be subscribed
+    const String &get_subscribe_message() { return subscribe_message_; }
+    int get_subscribed_count() { return subscribed_; }
+    /// Paths which had active subscription and are dropped by unsubscribe of all paths
+    int get_unsubscribed_count() { return unsubscribed_; }
+
+private:
+    void append_subscription(SignalKSubscription *subscription, uint period);
+    bool unsubscribe_all_ = false;
+    String subscribe_message_;
+    int subscribed_ = 0;
+    int unsubscribed_ = 0;
+};
@@ -0,0 +1,297 @@
+#include "signalk_tree_walker.h"
+#include <string.h>
+#include "system/psram.h"
+
+SignalKTreeWalker::SignalKTreeWalker(delta_value_callback callback, int max_value)
+{
+    callback_ = callback;
+    value_max_ = max_value;
+    // it's allocated once for the whole document, prefer PSRAM so we don't fragment internal RAM
+    value_ = (char *)twatchsk::psram_malloc(max_value);
+}
+
+SignalKTreeWalker::~SignalKTreeWalker()
+{
+    twatchsk::psram_free(value_);
+    value_ = NULL;
+}
+
+bool SignalKTreeWalker::feed(const char *data, int len)
+{
+    if (value_ == NULL)
+    {
+        state_ = WALK_ERROR;
+    }
+
+    for (int i = 0; i < len && state_ != WALK_ERROR && state_ != WALK_DONE; i++)
+    {
+        if (!step(data[i]))
+        {
+            state_ = WALK_ERROR;
+        }
+    }
+
+    return state_ != WALK_ERROR;
+}
+
+static bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool SignalKTreeWalker::step(char c)
+{
+    switch (state_)
+    {
+    case WALK_START:
+        if (c == '{')
+        {
+            depth_ = 1;
+            path_len_[0] = 0;
+            state_ = WALK_MEMBER;
+            return true;
+        }
+        return is_whitespace(c);
+
+    case WALK_MEMBER:
+        if (c == '"')
+        {
+            key_len_ = 0;
+            key_escape_ = false;
+            key_overflow_ = false;
+            state_ = WALK_KEY;
+        }
+        else if (c == '}')
+        {
+            if (--depth_ == 0)
+            {
+                state_ = WALK_DONE;
+            }
+        }
+        else if (c != ',' && !is_whitespace(c))
+        {
+            return false;
+        }
+        return true;
+
+    case WALK_KEY:
+        if (key_escape_)
+        {
+            key_escape_ = false;
+        }
+        else if (c == '\\')
+        {
+            key_escape_ = true;
+        }
+        else if (c == '"')
+        {
+            state_ = WALK_COLON;
+            return true;
+        }
+
+        // escape sequences are kept as they are (like in SignalKDeltaParser)
+        if (key_len_ < SK_TREE_PATH_MAX - 1)
+        {
+            key_[key_len_++] = c;
+        }
+        else
+        {
+            key_overflow_ = true;
+        }
+        return true;
+
+    case WALK_COLON:
+        if (c == ':')
+        {
+            state_ = WALK_VALUE;
+            return true;
+        }
+        return is_whitespace(c);
+
+    case WALK_VALUE:
+    {
+        if (is_whitespace(c))
+        {
+            return true;
+        }
+
+        int parent_len = path_len_[depth_ - 1];
+        if (parent_len > 0 && key_equals("value"))
+        {
+            return start_raw(c, true);
+        }
+
+        if (c == '{' && key_len_ > 0 && !key_overflow_ && !key_equals("meta") && !key_equals("values"))
+        {
+            int child_len = parent_len + (parent_len > 0 ? 1 : 0) + key_len_;
+            // paths longer than buffer can't be bound anyway
+            if (child_len < SK_TREE_PATH_MAX && depth_ < (int)(sizeof(path_len_) / sizeof(path_len_[0])))
+            {
+                if (parent_len > 0)
+                {
+                    path_[parent_len] = '.';
+                }
+                memcpy(path_ + child_len - key_len_, key_, key_len_);
+                path_len_[depth_++] = child_len;
+                state_ = WALK_MEMBER;
+                return true;
+            }
+        }
+
+        return start_raw(c, false);
+    }
+
+    case WALK_RAW:
+    {
+        bool consumed = true;
+        if (!raw_step(c, consumed))
+        {
+            return false;
+        }
+        // character which ends number / literal belongs to the object
+        return consumed || step(c);
+    }
+
+    case WALK_DONE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool SignalKTreeWalker::start_raw(char c, bool capture)
+{
+    raw_capture_ = capture;
+    raw_depth_ = 0;
+    raw_string_ = false;
+    raw_escape_ = false;
+    raw_scalar_ = false;
+    value_len_ = 0;
+    value_overflow_ = false;
+
+    if (c == ',' || c == ':' || c == '}' || c == ']')
+    {
+        return false;
+    }
+
+    if (c == '"')
+    {
+        raw_string_ = true;
+    }
+    else if (c == '{' || c == '[')
+    {
+        raw_depth_ = 1;
+    }
+    else
+    {
+        raw_scalar_ = true;
+    }
+
+    this->capture(c);
+    state_ = WALK_RAW;
+
+    return true;
+}
+
+bool SignalKTreeWalker::raw_step(char c, bool &consumed)
+{
+    consumed = true;
+
+    if (raw_scalar_)
+    {
+        if (is_whitespace(c) || c == ',' || c == '}' || c == ']')
+        {
+            consumed = false;
+            end_raw();
+        }
+        else
+        {
+            capture(c);
+        }
+        return true;
+    }
+
+    capture(c);
+
+    if (raw_string_)
+    {
+        if (raw_escape_)
+        {
+            raw_escape_ = false;
+        }
+        else if (c == '\\')
+        {
+            raw_escape_ = true;
+        }
+        else if (c == '"')
+        {
+            raw_string_ = false;
+            if (raw_depth_ == 0)
+            {
+                end_raw();
+            }
+        }
+    }
+    else if (c == '"')
+    {
+        raw_string_ = true;
+    }
+    else if (c == '{' || c == '[')
+    {
+        raw_depth_++;
+    }
+    else if (c == '}' || c == ']')
+    {
+        if (--raw_depth_ == 0)
+        {
+            end_raw();
+        }
+    }
+
+    return true;
+}
+
+void SignalKTreeWalker::end_raw()
+{
+    state_ = WALK_MEMBER;
+
+    if (!raw_capture_)
+    {
+        return;
+    }
+
+    if (value_overflow_)
+    {
+        skipped_count_++;
+        return;
+    }
+
+    int path_len = path_len_[depth_ - 1];
+    path_[path_len] = '\0';
+    SignalKDeltaValue_t value = {path_, path_len, value_, value_len_};
+    value_count_++;
+    callback_(value);
+}
+
+void SignalKTreeWalker::capture(char c)
+{
+    if (!raw_capture_)
+    {
+        return;
+    }
+
+    if (value_len_ < value_max_)
+    {
+        value_[value_len_++] = c;
+    }
+    else
+    {
+        value_overflow_ = true;
+    }
+}
+
+bool SignalKTreeWalker::key_equals(const char *literal)
+{
+    return strncmp(key_, literal, key_len_) == 0 && literal[key_len_] == '\0';
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include "networking/signalk_delta_parser.h"
+
+#define SK_TREE_VALUE_MAX 2048 // longer values (raw JSON) of the data model are skipped
+#define SK_TREE_PATH_MAX 128   // longer paths can't be bound anyway, they are skipped
+
+/**
+ * @brief Incremental walker of full SignalK data model (REST response of /signalk/v1/api/vessels/self) - the model
+ * is walked as it's received in HTTP chunks, so the response doesn't have to be buffered. Callback is invoked for
+ * every leaf object with "value" member, only raw JSON of the "value" member that's being received is copied
+ * (into buffer of max_value bytes) and callback gets the value once it's complete. Path is built as dotted path
+ * (navigation.speedOverGround, "meta" and "values" sub-objects are skipped) and it's valid only during the callback.
+ **/
+class SignalKTreeWalker
+{
+public:
+    SignalKTreeWalker(delta_value_callback callback, int max_value = SK_TREE_VALUE_MAX);
+    ~SignalKTreeWalker();
+    /**
+     * @brief Walks next chunk of the document
+     * @return false if document isn't valid JSON object (the rest is ignored)
+     **/
+    bool feed(const char *data, int len);
+    /// True if the whole (root) object has been walked
+    bool is_complete() { return state_ == WALK_DONE; }
+    int get_value_count() { return value_count_; }
+    /// Values which didn't fit into value buffer
+    int get_skipped_count() { return skipped_count_; }
+
+private:
+    enum WalkState_t
+    {
+        WALK_START,  // before root object
+        WALK_MEMBER, // in object, before key / comma / end of object
+        WALK_KEY,    // in key string
+        WALK_COLON,  // after key
+        WALK_VALUE,  // before member value
+        WALK_RAW,    // in member value which is skipped or captured
+        WALK_DONE,
+        WALK_ERROR
+    };
+
+    bool step(char c);
+    bool start_raw(char c, bool capture);
+    bool raw_step(char c, bool &consumed);
+    void end_raw();
+    void capture(char c);
+    bool key_equals(const char *literal);
+
+    delta_value_callback callback_;
+    WalkState_t state_ = WALK_START;
+    char path_[SK_TREE_PATH_MAX];
+    int path_len_[SK_TREE_PATH_MAX / 2 + 1]; // path length of every object level
+    int depth_ = 0;                          // object levels of the tree being walked
+    char key_[SK_TREE_PATH_MAX];
+    int key_len_ = 0;
+    bool key_escape_ = false;
+    bool key_overflow_ = false;
+    // member value which is skipped or captured (it can be split between chunks)
+    bool raw_capture_ = false;
+    int raw_depth_ = 0;
+    bool raw_string_ = false;
+    bool raw_escape_ = false;
+    bool raw_scalar_ = false;
+    char *value_;
+    int value_len_ = 0;
+    int value_max_;
+    bool value_overflow_ = false;
+    int value_count_ = 0;
+    int skipped_count_ = 0;
+};
@@ -0,0 +1,229 @@
+#include "signalk_value.h"
+#include <string.h>
+#include <stdlib.h>
+
+/// Reads 4 hex digits of \uXXXX escape, returns -1 if any of them isn't hex digit
+static int32_t parse_hex4(const char *hex)
+{
+    int32_t ret = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        char c = hex[i];
+        ret <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+            ret |= c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            ret |= c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            ret |= c - 'A' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return ret;
+}
+
+/// Encodes code point as UTF-8, returns number of bytes (0 if it doesn't fit into size)
+static int encode_utf8(uint32_t code_point, char *out, int size)
+{
+    if (code_point < 0x80 && size >= 1)
+    {
+        out[0] = (char)code_point;
+        return 1;
+    }
+    else if (code_point < 0x800 && size >= 2)
+    {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    else if (code_point >= 0x800 && code_point < 0x10000 && size >= 3)
+    {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    else if (code_point >= 0x10000 && size >= 4)
+    {
+        out[0] = (char)(0xF0 | (code_point >> 18));
+        out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+
+    return 0;
+}
+
+bool SignalKValue_t::parse(const char *json, int json_len)
+{
+    type = SK_VALUE_NULL;
+    text[0] = '\0';
+
+    if (json_len <= 0)
+    {
+        return true;
+    }
+
+    char first = json[0];
+
+    if (first == '"')
+    {
+        // copy string without quotes and resolve escape sequences (\uXXXX is decoded to UTF-8)
+        int end = json_len - 1;
+        int length = 0;
+        for (int i = 1; i < end; i++)
+        {
+            char encoded[4];
+            int encoded_len = 1;
+            encoded[0] = json[i];
+
+            if (json[i] == '\\')
+            {
+                if (i + 1 >= end)
+                {
+                    text[0] = '\0';
+                    return false;
+                }
+
+                i++;
+                switch (json[i])
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    encoded[0] = json[i];
+                    break;
+                case 'b':
+                    encoded[0] = '\b';
+                    break;
+                case 'f':
+                    encoded[0] = '\f';
+                    break;
+                case 'n':
+                    encoded[0] = '\n';
+                    break;
+                case 'r':
+                    encoded[0] = '\r';
+                    break;
+                case 't':
+                    encoded[0] = '\t';
+                    break;
+                case 'u':
+                {
+                    int32_t code_point = i + 4 < end ? parse_hex4(json + i + 1) : -1;
+                    if (code_point < 0)
+                    {
+                        text[0] = '\0';
+                        return false;
+                    }
+                    i += 4;
+
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                    {
+                        // high surrogate has to be followed by \uDC00 - \uDFFF escape
+                        int32_t low = i + 6 < end && json[i + 1] == '\\' && json[i + 2] == 'u' ? parse_hex4(json + i + 3) : -1;
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                            i += 6;
+                        }
+                        else
+                        {
+                            code_point = 0xFFFD;
+                        }
+                    }
+                    else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                    {
+                        code_point = 0xFFFD; // lone low surrogate
+                    }
+
+                    encoded_len = encode_utf8(code_point, encoded, sizeof(encoded));
+                    break;
+                }
+                default:
+                    // invalid escape, let ArduinoJson deal with the spilled value
+                    text[0] = '\0';
+                    return false;
+                }
+            }
+
+            if (length + encoded_len > SK_VALUE_TEXT_MAX - 1)
+            {
+                text[0] = '\0';
+                return false;
+            }
+            memcpy(text + length, encoded, encoded_len);
+            length += encoded_len;
+        }
+
+        text[length] = '\0';
+        type = SK_VALUE_STRING;
+    }
+    else if (first == '{' || first == '[')
+    {
+        if (json_len >= SK_VALUE_TEXT_MAX)
+        {
+            return false;
+        }
+
+        memcpy(text, json, json_len);
+        text[json_len] = '\0';
+        type = SK_VALUE_JSON;
+    }
+    else if (first == 't')
+    {
+        boolean = true;
+        type = SK_VALUE_BOOL;
+    }
+    else if (first == 'f')
+    {
+        boolean = false;
+        type = SK_VALUE_BOOL;
+    }
+    else if (first == 'n')
+    {
+        type = SK_VALUE_NULL;
+    }
+    else
+    {
+        char buffer[32];
+        int length = json_len < (int)sizeof(buffer) - 1 ? json_len : sizeof(buffer) - 1;
+        bool is_integer = true;
+
+        memcpy(buffer, json, length);
+        buffer[length] = '\0';
+
+        for (int i = 0; i < length; i++)
+        {
+            if (buffer[i] == '.' || buffer[i] == 'e' || buffer[i] == 'E')
+            {
+                is_integer = false;
+                break;
+            }
+        }
+
+        if (is_integer && length < 10)
+        {
+            integer = atol(buffer);
+            type = SK_VALUE_INT;
+        }
+        else
+        {
+            number = strtod(buffer, NULL);
+            type = SK_VALUE_NUMBER;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "networking/signalk_path_index.h"
+
+#define SK_VALUE_TEXT_MAX 64
+
+enum SignalKValueType_t
+{
+    SK_VALUE_NULL,
+    SK_VALUE_INT,
+    SK_VALUE_NUMBER,
+    SK_VALUE_BOOL,
+    SK_VALUE_STRING,
+    SK_VALUE_JSON,   // objects and arrays are kept as (short) JSON text
+    SK_VALUE_SPILLED // value doesn't fit into inline storage, its raw JSON is passed on heap (see SignalKValueCoalescer)
+};
+
+/**
+ * @brief Typed SignalK value with inline storage - it can be copied around without any heap allocation.
+ * It doesn't depend on ArduinoJson (see DataAdapter::value_to_json), so it's part of host build (tools/host).
+ **/
+struct SignalKValue_t
+{
+    SignalKValueType_t type = SK_VALUE_NULL;
+    union
+    {
+        int32_t integer;
+        double number;
+        bool boolean;
+    };
+    char text[SK_VALUE_TEXT_MAX];
+
+    /**
+     * @brief Fills value from raw JSON text (as handed out by SignalKDeltaParser), strings are never truncated
+     * @return false if value (string, object) doesn't fit into inline storage or string has malformed escape sequence,
+     * such value has to be spilled
+     **/
+    bool parse(const char *json, int json_len);
+};
+
+/**
+ * @brief Value update record passed from websocket task to GUI task.
+ **/
+struct SignalKUpdate_t
+{
+    sk_path_id_t path_id;
+    uint32_t timestamp; // ms since boot when value was received
+    SignalKValue_t value;
+};
@@ -0,0 +1,288 @@
+#include "signalk_value_cache.h"
+#include <string.h>
+#include <time.h>
+#include "Arduino.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "SPIFFS.h"
+#include "system/async_dispatcher.h"
+#include <atomic>
+
+#define SK_VALUE_CACHE_MAGIC 0x534B5632 // "SKV2" - entries with own checksum
+#define SK_VALUE_CACHE_FILE "/config/sk_values.bin"
+
+struct ValueCacheData_t
+{
+    uint32_t magic;
+    SignalKCachedValue_t entries[SK_VALUE_CACHE_SIZE];
+};
+
+static const char *VALUE_CACHE_TAG = "VALUE_CACHE";
+// RTC slow memory isn't cleared by software reset or light sleep, magic and entry checksums detect garbage after power on
+RTC_NOINIT_ATTR static ValueCacheData_t rtc_cache;
+static uint32_t path_hashes[SK_PATH_INDEX_MAX];  // hash of interned path, 0 = not computed yet
+static uint8_t path_entries[SK_PATH_INDEX_MAX];  // entry index + 1 of interned path, 0 = unknown
+// flush is started on GUI task and finished on async task
+static std::atomic<bool> cache_dirty(false);
+static std::atomic<bool> flush_running(false);
+static unsigned long last_flush = 0;
+
+uint32_t SignalKValueCache::checksum(const SignalKCachedValue_t &entry)
+{
+    // only the entry that has been changed is hashed, the whole cache would be ~2 kB for every value
+    return SignalKPathIndex::hash((const char *)&entry + sizeof(entry.checksum), sizeof(entry) - sizeof(entry.checksum));
+}
+
+int SignalKValueCache::validate()
+{
+    if (rtc_cache.magic != SK_VALUE_CACHE_MAGIC)
+    {
+        return -1;
+    }
+
+    int ret = 0;
+    for (int i = 0; i < SK_VALUE_CACHE_SIZE; i++)
+    {
+        auto &entry = rtc_cache.entries[i];
+        if (entry.path_hash != 0)
+        {
+            if (entry.checksum == checksum(entry))
+            {
+                ret++;
+            }
+            else
+            {
+                memset(&entry, 0, sizeof(entry));
+            }
+        }
+    }
+
+    return ret;
+}
+
+void SignalKValueCache::restore()
+{
+    memset(path_hashes, 0, sizeof(path_hashes));
+    memset(path_entries, 0, sizeof(path_entries));
+
+    int valid = validate();
+    if (valid > 0)
+    {
+        ESP_LOGI(VALUE_CACHE_TAG, "%d values restored from RTC memory.", valid);
+        return;
+    }
+
+    if (SPIFFS.exists(SK_VALUE_CACHE_FILE))
+    {
+        auto file = SPIFFS.open(SK_VALUE_CACHE_FILE);
+        valid = file.read((uint8_t *)&rtc_cache, sizeof(rtc_cache)) == sizeof(rtc_cache) ? validate() : -1;
+        file.close();
+    }
+
+    if (valid > 0)
+    {
+        ESP_LOGI(VALUE_CACHE_TAG, "%d values restored from %s.", valid, SK_VALUE_CACHE_FILE);
+    }
+    else
+    {
+        memset(&rtc_cache, 0, sizeof(rtc_cache));
+        rtc_cache.magic = SK_VALUE_CACHE_MAGIC;
+        ESP_LOGI(VALUE_CACHE_TAG, "No cached values found.");
+    }
+}
+
+int SignalKValueCache::find_entry(sk_path_id_t path_id, bool create)
+{
+    if (path_id >= SK_PATH_INDEX_MAX)
+    {
+        return -1;
+    }
+
+    if (path_hashes[path_id] == 0)
+    {
+        auto path = SignalKPathIndex::get_path(path_id);
+        if (path == NULL)
+        {
+            return -1;
+        }
+
+        path_hashes[path_id] = SignalKPathIndex::hash(path, strlen(path));
+        // 0 marks empty entry
+        if (path_hashes[path_id] == 0)
+        {
+            path_hashes[path_id] = 1;
+        }
+    }
+
+    uint32_t path_hash = path_hashes[path_id];
+    int ret = path_entries[path_id] - 1;
+
+    if (ret >= 0 && rtc_cache.entries[ret].path_hash == path_hash)
+    {
+        return ret;
+    }
+
+    ret = -1;
+    int empty = -1;
+    int oldest = 0;
+
+    for (int i = 0; i < SK_VALUE_CACHE_SIZE; i++)
+    {
+        auto &entry = rtc_cache.entries[i];
+        if (entry.path_hash == path_hash)
+        {
+            ret = i;
+            break;
+        }
+        else if (entry.path_hash == 0)
+        {
+            if (empty < 0)
+            {
+                empty = i;
+            }
+        }
+        else if (entry.timestamp < rtc_cache.entries[oldest].timestamp)
+        {
+            oldest = i;
+        }
+    }
+
+    if (ret < 0 && create)
+    {
+        // cache is full - the value which wasn't updated for the longest time is replaced
+        ret = empty >= 0 ? empty : oldest;
+        rtc_cache.entries[ret].path_hash = path_hash;
+    }
+
+    if (ret >= 0)
+    {
+        path_entries[path_id] = ret + 1;
+    }
+
+    return ret;
+}
+
+void SignalKValueCache::store(sk_path_id_t path_id, const SignalKValue_t &value)
+{
+    bool cacheable = value.type != SK_VALUE_STRING && value.type != SK_VALUE_JSON && value.type != SK_VALUE_SPILLED;
+
+    if (value.type == SK_VALUE_STRING || value.type == SK_VALUE_JSON)
+    {
+        cacheable = strlen(value.text) < SK_VALUE_CACHE_TEXT_MAX;
+    }
+
+    auto index = find_entry(path_id, cacheable);
+    if (index < 0)
+    {
+        return;
+    }
+
+    auto &entry = rtc_cache.entries[index];
+
+    if (cacheable)
+    {
+        entry.timestamp = (uint32_t)time(NULL);
+        entry.type = (uint8_t)value.type;
+
+        switch (value.type)
+        {
+        case SK_VALUE_INT:
+            entry.integer = value.integer;
+            break;
+        case SK_VALUE_NUMBER:
+            entry.number = value.number;
+            break;
+        case SK_VALUE_BOOL:
+            entry.boolean = value.boolean;
+            break;
+        case SK_VALUE_STRING:
+        case SK_VALUE_JSON:
+            strcpy(entry.text, value.text);
+            break;
+        default:
+            break;
+        }
+
+        entry.checksum = checksum(entry);
+    }
+    else
+    {
+        // cached value would be older than the one shown, so it's better to have nothing
+        entry.path_hash = 0;
+        path_entries[path_id] = 0;
+    }
+
+    cache_dirty = true;
+}
+
+bool SignalKValueCache::get(sk_path_id_t path_id, SignalKValue_t &value)
+{
+    auto index = find_entry(path_id, false);
+    if (index < 0)
+    {
+        return false;
+    }
+
+    auto &entry = rtc_cache.entries[index];
+    value.type = (SignalKValueType_t)entry.type;
+    value.text[0] = '\0';
+
+    switch (value.type)
+    {
+    case SK_VALUE_INT:
+        value.integer = entry.integer;
+        break;
+    case SK_VALUE_NUMBER:
+        value.number = entry.number;
+        break;
+    case SK_VALUE_BOOL:
+        value.boolean = entry.boolean;
+        break;
+    case SK_VALUE_STRING:
+    case SK_VALUE_JSON:
+        strlcpy(value.text, entry.text, SK_VALUE_CACHE_TEXT_MAX);
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+void SignalKValueCache::flush(uint32_t debounce_ms)
+{
+    if (!cache_dirty || flush_running || (last_flush != 0 && millis() - last_flush < debounce_ms))
+    {
+        return;
+    }
+
+    auto copy = (ValueCacheData_t *)malloc(sizeof(ValueCacheData_t));
+    if (copy == NULL)
+    {
+        return;
+    }
+
+    memcpy(copy, &rtc_cache, sizeof(ValueCacheData_t));
+    cache_dirty = false;
+    flush_running = true;
+    last_flush = millis();
+
+    twatchsk::run_async("SK cache flush", [copy]()
+                        {
+                            auto file = SPIFFS.open(SK_VALUE_CACHE_FILE, "w");
+                            if (file)
+                            {
+                                file.write((const uint8_t *)copy, sizeof(ValueCacheData_t));
+                                file.close();
+                                ESP_LOGI(VALUE_CACHE_TAG, "Values flushed to %s.", SK_VALUE_CACHE_FILE);
+                            }
+                            else
+                            {
+                                ESP_LOGW(VALUE_CACHE_TAG, "Unable to write %s!", SK_VALUE_CACHE_FILE);
+                                cache_dirty = true;
+                            }
+
+                            free(copy);
+                            flush_running = false;
+                        });
+}
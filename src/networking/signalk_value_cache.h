@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include "networking/signalk_path_index.h"
+#include "networking/signalk_value.h"
+
+#define SK_VALUE_CACHE_SIZE 64                 // maximum number of cached paths
+#define SK_VALUE_CACHE_TEXT_MAX 16             // longer strings and JSON values aren't cached
+#define SK_VALUE_CACHE_MIN_FLUSH_INTERVAL 60000 // ms between SPIFFS flushes when watch goes to low power
+
+/**
+ * @brief Compact cached value, path is stored as hash because path IDs can differ between boots
+ **/
+struct SignalKCachedValue_t
+{
+    uint32_t checksum;  // of the rest of the entry, entries are validated one by one
+    uint32_t path_hash; // 0 = empty entry
+    uint32_t timestamp; // unix time when value was received
+    uint8_t type;
+    union
+    {
+        int32_t integer;
+        double number;
+        bool boolean;
+        char text[SK_VALUE_CACHE_TEXT_MAX];
+    };
+};
+
+/**
+ * @brief Last known value of every bound path. Values live in RTC slow memory, so they survive light sleep and software
+ * resets, and they are flushed to SPIFFS when the watch goes to low power to survive power loss.
+ * Store and flush are called only from GUI task.
+ **/
+class SignalKValueCache
+{
+public:
+    /// Validates RTC copy of the cache and loads it from SPIFFS if it isn't valid (after power on)
+    static void restore();
+    static void store(sk_path_id_t path_id, const SignalKValue_t &value);
+    /// Returns cached value of the path, false if there is none
+    static bool get(sk_path_id_t path_id, SignalKValue_t &value);
+    /// Writes cache to SPIFFS in background if it has been changed and last flush is older than debounce_ms
+    static void flush(uint32_t debounce_ms);
+
+private:
+    SignalKValueCache() {}
+    static int find_entry(sk_path_id_t path_id, bool create);
+    static uint32_t checksum(const SignalKCachedValue_t &entry);
+    /// Clears entries with wrong checksum, returns number of valid entries (-1 if cache isn't initialized at all)
+    static int validate();
+};
@@ -0,0 +1,281 @@
+#include "ws_frame_assembler.h"
+#include <string.h>
+#include "system/psram.h"
+#include "esp_log.h"
+
+static const char *WSA_TAG = "WSA";
+
+WebsocketFrameAssembler::WebsocketFrameAssembler(int max_size)
+{
+    max_size_ = max_size;
+}
+
+WebsocketFrameAssembler::~WebsocketFrameAssembler()
+{
+    if (buffer_ != NULL)
+    {
+        twatchsk::psram_free(buffer_);
+        buffer_ = NULL;
+    }
+}
+
+bool WebsocketFrameAssembler::append(int op_code, const char *data, int data_len, int payload_len, int payload_offset, int fin)
+{
+    message_ = NULL;
+    message_len_ = 0;
+
+    if (op_code >= WS_OPCODE_CLOSE)
+    {
+        // control frames are never fragmented and they can come between fragments of a message
+        return false;
+    }
+
+    if (payload_offset == 0)
+    {
+        if ((pending_ || skipping_) && frame_received_ < frame_expected_)
+        {
+            drop_incomplete("frame");
+        }
+
+        if (op_code != WS_OPCODE_CONTINUATION)
+        {
+            if (pending_)
+            {
+                // previous message didn't get all its continuation frames
+                drop_incomplete("message");
+            }
+
+            skipping_ = false;
+            start_message(op_code);
+        }
+        else if (!pending_ && !skipping_)
+        {
+            ESP_LOGW(WSA_TAG, "Dropping continuation frame without start of message (%d bytes)", payload_len);
+            dropped_incomplete_++;
+            // skip rest of this frame only, it's the best guess where next message starts
+            skipping_ = true;
+            started_ = true;
+            scalar_ = true;
+        }
+
+        frame_expected_ = payload_len;
+        frame_received_ = 0;
+    }
+    else if ((!pending_ && !skipping_) || payload_offset != frame_received_ || payload_len != frame_expected_ ||
+             frame_received_ + data_len > frame_expected_)
+    {
+        ESP_LOGW(WSA_TAG, "Unexpected chunk opcode=%d, offset=%d, len=%d (expected offset=%d)", op_code, payload_offset, data_len, frame_received_);
+        if (pending_)
+        {
+            dropped_incomplete_++;
+        }
+        reset();
+        return false;
+    }
+
+    if (fin == WS_FIN_UNKNOWN)
+    {
+        scan(data, data_len);
+    }
+
+    int frame_left = frame_expected_ - frame_received_;
+    frame_received_ += data_len;
+    chunks_++;
+    bool frame_end = frame_received_ >= frame_expected_;
+
+    if (frame_end && chunks_ == 1 && !skipping_ && is_message_end(fin))
+    {
+        // whole message in single chunk - no copy needed
+        pending_ = false;
+        frame_expected_ = 0;
+        frame_received_ = 0;
+        message_ = data;
+        message_len_ = data_len;
+        return true;
+    }
+
+    if (!skipping_)
+    {
+        // room for the rest of the frame is reserved at once, so chunks of large frame don't grow the buffer
+        if (received_ + frame_left > max_size_ || !ensure_capacity(received_ + frame_left))
+        {
+            ESP_LOGW(WSA_TAG, "Dropping message with size over %d bytes (max=%d)", received_ + frame_left, max_size_);
+            dropped_oversize_++;
+            pending_ = false;
+            skipping_ = true;
+        }
+        else if (data_len > 0)
+        {
+            memcpy(buffer_ + received_, data, data_len);
+            received_ += data_len;
+        }
+    }
+
+    if (!frame_end || !is_message_end(fin))
+    {
+        return false;
+    }
+
+    frame_expected_ = 0;
+    frame_received_ = 0;
+
+    if (skipping_)
+    {
+        skipping_ = false;
+        return false;
+    }
+
+    pending_ = false;
+    reassembled_++;
+    message_ = buffer_;
+    message_len_ = received_;
+
+    return true;
+}
+
+void WebsocketFrameAssembler::reset()
+{
+    pending_ = false;
+    skipping_ = false;
+    received_ = 0;
+    frame_received_ = 0;
+    frame_expected_ = 0;
+    chunks_ = 0;
+    message_ = NULL;
+    message_len_ = 0;
+}
+
+void WebsocketFrameAssembler::drop_incomplete(const char *reason)
+{
+    ESP_LOGW(WSA_TAG, "Dropping incomplete %s (%d bytes of message received)", reason, received_);
+    if (pending_)
+    {
+        dropped_incomplete_++;
+    }
+    reset();
+}
+
+void WebsocketFrameAssembler::start_message(int op_code)
+{
+    op_code_ = op_code;
+    pending_ = true;
+    received_ = 0;
+    chunks_ = 0;
+    depth_ = 0;
+    started_ = false;
+    scalar_ = false;
+    in_string_ = false;
+    escape_ = false;
+    closed_ = false;
+}
+
+void WebsocketFrameAssembler::scan(const char *data, int data_len)
+{
+    if (op_code_ != WS_OPCODE_TEXT || closed_ || scalar_)
+    {
+        return;
+    }
+
+    for (int i = 0; i < data_len; i++)
+    {
+        char c = data[i];
+
+        if (!started_)
+        {
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            {
+                continue;
+            }
+
+            started_ = true;
+            if (c != '{' && c != '[')
+            {
+                // not a SignalK message, it ends with the frame
+                scalar_ = true;
+                return;
+            }
+
+            depth_ = 1;
+        }
+        else if (in_string_)
+        {
+            if (escape_)
+            {
+                escape_ = false;
+            }
+            else if (c == '\\')
+            {
+                escape_ = true;
+            }
+            else if (c == '"')
+            {
+                in_string_ = false;
+            }
+        }
+        else if (c == '"')
+        {
+            in_string_ = true;
+        }
+        else if (c == '{' || c == '[')
+        {
+            depth_++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (--depth_ == 0)
+            {
+                closed_ = true;
+                return;
+            }
+        }
+    }
+}
+
+bool WebsocketFrameAssembler::is_message_end(int fin)
+{
+    if (fin != WS_FIN_UNKNOWN)
+    {
+        return fin != 0;
+    }
+
+    if (op_code_ != WS_OPCODE_TEXT)
+    {
+        // without FIN bit binary message can't be told apart from its fragments, SignalK doesn't send any
+        return true;
+    }
+
+    return !started_ || scalar_ || closed_;
+}
+
+bool WebsocketFrameAssembler::ensure_capacity(int size)
+{
+    if (capacity_ >= size)
+    {
+        return true;
+    }
+
+    int capacity = capacity_ * 2 > size ? capacity_ * 2 : size;
+    if (capacity > max_size_)
+    {
+        capacity = max_size_;
+    }
+
+    // buffer is kept for next messages, prefer PSRAM so we don't fragment internal RAM
+    char *buffer = (char *)twatchsk::psram_malloc(capacity);
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    if (buffer_ != NULL)
+    {
+        // fragmented message doesn't announce its size, so buffer can grow while message is received
+        memcpy(buffer, buffer_, received_);
+        twatchsk::psram_free(buffer_);
+    }
+
+    buffer_ = buffer;
+    capacity_ = capacity;
+
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define WS_MAX_MESSAGE_SIZE 32768
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_CLOSE 0x8 // this one and higher are control frames
+#define WS_FIN_UNKNOWN -1
+
+/**
+ * @brief Reassembles websocket messages from what esp_websocket_client delivers in WEBSOCKET_EVENT_DATA events:
+ *  - chunks of one frame (when frame is larger than client rx buffer), matched by payload offset
+ *  - frames of one fragmented message (RFC 6455 continuation frames with opcode 0)
+ * Data is copied into reassembly buffer that is allocated in PSRAM (if available) and never grows over max_size.
+ * Messages received in single chunk of single frame are passed through without any copy.
+ *
+ * End of message is given by FIN bit if the client reports it (IDF 5.0+). Older clients don't, so end of text
+ * message is found by tracking JSON nesting (every SignalK message is JSON object) and message ends with the frame
+ * that closes the outer object. Control frames (ping, pong, close) can come between fragments and are ignored.
+ **/
+class WebsocketFrameAssembler
+{
+public:
+    WebsocketFrameAssembler(int max_size = WS_MAX_MESSAGE_SIZE);
+    ~WebsocketFrameAssembler();
+    /**
+     * @brief Appends received chunk
+     * @param fin FIN bit of the frame (0 / 1) or WS_FIN_UNKNOWN if the client doesn't report it
+     * @return true if message is complete and can be read via get_data() / get_length()
+     **/
+    bool append(int op_code, const char *data, int data_len, int payload_len, int payload_offset, int fin = WS_FIN_UNKNOWN);
+    /// Drops partially received message (call it on connect / disconnect)
+    void reset();
+    const char *get_data() { return message_; }
+    int get_length() { return message_len_; }
+    /// Opcode of the first frame of the message (text / binary)
+    int get_op_code() { return op_code_; }
+    uint32_t get_dropped_oversize_count() { return dropped_oversize_; }
+    uint32_t get_dropped_incomplete_count() { return dropped_incomplete_; }
+    uint32_t get_reassembled_count() { return reassembled_; }
+
+private:
+    bool ensure_capacity(int size);
+    void drop_incomplete(const char *reason);
+    void start_message(int op_code);
+    void scan(const char *data, int data_len);
+    bool is_message_end(int fin);
+    int max_size_;
+    char *buffer_ = NULL;
+    int capacity_ = 0;
+    int received_ = 0;       // bytes of the message in buffer
+    int frame_received_ = 0; // bytes of current frame
+    int frame_expected_ = 0; // payload length of current frame
+    int chunks_ = 0;         // chunks of the message so far
+    int op_code_ = 0;
+    bool pending_ = false;   // message started and it's buffered
+    bool skipping_ = false;  // oversize message is being skipped till its end
+    // JSON nesting of text message, used when FIN bit isn't known
+    int depth_ = 0;
+    bool started_ = false;
+    bool scalar_ = false;
+    bool in_string_ = false;
+    bool escape_ = false;
+    bool closed_ = false;
+    const char *message_ = NULL;
+    int message_len_ = 0;
+    uint32_t dropped_oversize_ = 0;
+    uint32_t dropped_incomplete_ = 0;
+    uint32_t reassembled_ = 0;
+};
@@ -0,0 +1,60 @@
+#include "ws_keepalive.h"
+#include "esp_log.h"
+
+static const char *KEEPALIVE_TAG = "WS_KEEPALIVE";
+
+void WebsocketKeepalive::set_ping_intervals(uint32_t awake_sec, uint32_t low_power_sec)
+{
+    awake_interval_ = awake_sec > 0 ? awake_sec : WS_PING_INTERVAL_DEFAULT;
+    low_power_interval_ = low_power_sec > 0 ? low_power_sec : WS_PING_INTERVAL_LOW_POWER_DEFAULT;
+}
+
+void WebsocketKeepalive::configure(esp_websocket_client_config_t &config, bool low_power)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+    config.ping_interval_sec = get_ping_interval(low_power);
+    client_interval_ = get_ping_interval(low_power);
+#else
+    // client of older IDF pings with its default interval and it can't be changed, liveness check still works
+    client_interval_ = WS_CLIENT_PING_INTERVAL;
+    ESP_LOGD(KEEPALIVE_TAG, "Ping interval isn't configurable with this IDF version.");
+#endif
+}
+
+void WebsocketKeepalive::apply(esp_websocket_client_handle_t client, bool low_power)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    if (client != NULL)
+    {
+        esp_websocket_client_set_ping_interval_sec(client, get_ping_interval(low_power));
+        client_interval_ = get_ping_interval(low_power);
+        ESP_LOGI(KEEPALIVE_TAG, "Ping interval set to %u s", (unsigned)get_ping_interval(low_power));
+    }
+#endif
+}
+
+void WebsocketKeepalive::on_connected(int64_t now_us)
+{
+    last_received_us_ = now_us;
+}
+
+uint32_t WebsocketKeepalive::get_liveness_timeout()
+{
+    // two missed pongs plus time for the server to answer
+    uint32_t timeout = client_interval_ * 2 + 10;
+    return timeout > WS_LIVENESS_MIN_TIMEOUT ? timeout : WS_LIVENESS_MIN_TIMEOUT;
+}
+
+bool WebsocketKeepalive::is_alive(int64_t now_us)
+{
+    int64_t silent_sec = (now_us - last_received_us_) / 1000000;
+
+    if (silent_sec > (int64_t)get_liveness_timeout())
+    {
+        dead_count_++;
+        ESP_LOGW(KEEPALIVE_TAG, "Nothing received for %d s, connection is dead.", (int)silent_sec);
+        return false;
+    }
+
+    return true;
+}
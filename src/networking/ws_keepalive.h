@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include "esp_idf_version.h"
+#include "esp_websocket_client.h"
+
+#define WS_PING_INTERVAL_DEFAULT 10            // s between pings when the watch is in use
+#define WS_PING_INTERVAL_LOW_POWER_DEFAULT 120 // s between pings in low power mode
+#define WS_LIVENESS_MIN_TIMEOUT 30             // s without any received frame before connection is considered dead
+#define WS_LIVENESS_CHECK_PERIOD 5000          // ms between liveness checks when the watch is in use
+#define WS_CLIENT_PING_INTERVAL 10             // s, default ping interval of websocket client (the only one before IDF 4.3)
+
+/**
+ * @brief Keeps websocket connection alive and detects dead connections. Ping interval is configured
+ * per power mode through public websocket client API (where IDF supports it, older client keeps its default
+ * interval), liveness is decided at application level - every received frame (delta, response, pong) proves
+ * the server is alive, so pings are needed only when the stream is quiet.
+ **/
+class WebsocketKeepalive
+{
+public:
+    void set_ping_intervals(uint32_t awake_sec, uint32_t low_power_sec);
+    uint32_t get_ping_interval(bool low_power) { return low_power ? low_power_interval_ : awake_interval_; }
+    uint32_t get_awake_ping_interval() { return awake_interval_; }
+    uint32_t get_low_power_ping_interval() { return low_power_interval_; }
+    /// Sets ping interval of new websocket client
+    void configure(esp_websocket_client_config_t &config, bool low_power);
+    /// Changes ping interval of running client when power mode changes (needs IDF 5.0, older versions use interval from connect)
+    void apply(esp_websocket_client_handle_t client, bool low_power);
+    /// Interval the running client really pings with, liveness timeout is derived from it
+    uint32_t get_client_ping_interval() { return client_interval_; }
+    void on_connected(int64_t now_us);
+    /// Called for every received frame
+    void on_received(int64_t now_us) { last_received_us_ = now_us; }
+    /// Returns false if nothing was received for longer than liveness timeout
+    bool is_alive(int64_t now_us);
+    /// Two ping intervals of running client plus time to answer (at least WS_LIVENESS_MIN_TIMEOUT)
+    uint32_t get_liveness_timeout();
+    uint32_t get_dead_count() { return dead_count_; }
+
+private:
+    uint32_t awake_interval_ = WS_PING_INTERVAL_DEFAULT;
+    uint32_t low_power_interval_ = WS_PING_INTERVAL_LOW_POWER_DEFAULT;
+    uint32_t client_interval_ = WS_CLIENT_PING_INTERVAL;
+    volatile int64_t last_received_us_ = 0;
+    uint32_t dead_count_ = 0;
+};
@@ -0,0 +1,133 @@
+#include "ws_outbound_queue.h"
+#include <string.h>
+#include "Arduino.h"
+#include "esp_log.h"
+
+static const char *WSQ_TAG = "WSQ";
+
+WebsocketOutboundQueue::WebsocketOutboundQueue()
+{
+    lock_ = xSemaphoreCreateMutex();
+    available_ = xSemaphoreCreateCounting(WS_OUTBOUND_QUEUE_SIZE * WS_PRIORITY_COUNT, 0);
+}
+
+bool WebsocketOutboundQueue::push(const char *text, int length, OutboundPriority_t priority, OutboundMergeKey_t merge_key, uint32_t timeout_ms, send_callback callback)
+{
+    auto message = new OutboundMessage_t();
+    message->text = (char *)malloc(length + 1);
+    if (message->text == NULL)
+    {
+        delete message;
+        if (callback != nullptr)
+        {
+            callback(false);
+        }
+        return false;
+    }
+
+    memcpy(message->text, text, length);
+    message->text[length] = '\0';
+    message->length = length;
+    message->priority = priority;
+    message->merge_key = merge_key;
+    message->deadline = millis() + timeout_ms;
+    message->callback = callback;
+
+    OutboundMessage_t *superseded = NULL;
+    bool queued = false;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    auto &queue = queues_[priority];
+
+    if (merge_key != WS_MERGE_NONE)
+    {
+        for (auto it = queue.begin(); it != queue.end(); it++)
+        {
+            if ((*it)->merge_key == merge_key)
+            {
+                // newer message takes place of the old one, so it isn't delayed by messages queued in between
+                superseded = *it;
+                *it = message;
+                queued = true;
+                merged_++;
+                break;
+            }
+        }
+    }
+
+    if (!queued && queue.size() < WS_OUTBOUND_QUEUE_SIZE)
+    {
+        queue.push_back(message);
+        queued = true;
+        xSemaphoreGive(available_);
+    }
+    else if (!queued)
+    {
+        dropped_++;
+    }
+    xSemaphoreGive(lock_);
+
+    if (superseded != NULL)
+    {
+        complete(superseded, false);
+    }
+
+    if (!queued)
+    {
+        ESP_LOGW(WSQ_TAG, "Outbound queue %d is full, message dropped!", (int)priority);
+        complete(message, false);
+    }
+
+    return queued;
+}
+
+OutboundMessage_t *WebsocketOutboundQueue::pop(TickType_t wait)
+{
+    OutboundMessage_t *ret = NULL;
+
+    while (ret == NULL && xSemaphoreTake(available_, wait) == pdTRUE)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        for (int i = 0; i < WS_PRIORITY_COUNT; i++)
+        {
+            if (!queues_[i].empty())
+            {
+                ret = queues_[i].front();
+                queues_[i].pop_front();
+                break;
+            }
+        }
+        xSemaphoreGive(lock_);
+
+        if (ret != NULL && (int32_t)(millis() - ret->deadline) > 0)
+        {
+            expired_++;
+            ESP_LOGW(WSQ_TAG, "Outbound message expired before it was sent.");
+            complete(ret, false);
+            ret = NULL;
+        }
+    }
+
+    return ret;
+}
+
+void WebsocketOutboundQueue::complete(OutboundMessage_t *message, bool sent)
+{
+    if (message->callback != nullptr)
+    {
+        message->callback(sent);
+    }
+
+    free(message->text);
+    delete message;
+}
+
+void WebsocketOutboundQueue::clear()
+{
+    OutboundMessage_t *message;
+
+    while ((message = pop(0)) != NULL)
+    {
+        complete(message, false);
+    }
+}
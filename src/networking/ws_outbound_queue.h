@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <deque>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define WS_OUTBOUND_QUEUE_SIZE 8 // maximum number of queued messages of every priority
+
+enum OutboundPriority_t
+{
+    WS_PRIORITY_HIGH,   // PUT requests and access requests - user is waiting for them
+    WS_PRIORITY_NORMAL, // subscription changes
+    WS_PRIORITY_LOW,    // telemetry (status messages)
+    WS_PRIORITY_COUNT
+};
+
+enum OutboundMergeKey_t
+{
+    WS_MERGE_NONE,
+    WS_MERGE_STATUS // only the latest status message is kept in the queue
+};
+
+/// Called from sender task when message has been sent (true) or dropped / expired / failed (false)
+typedef std::function<void(bool)> send_callback;
+
+struct OutboundMessage_t
+{
+    char *text;
+    int length;
+    OutboundPriority_t priority;
+    OutboundMergeKey_t merge_key;
+    uint32_t deadline; // millis() after which message isn't sent anymore
+    send_callback callback;
+};
+
+/**
+ * @brief Bounded queue of outgoing websocket messages. Producers (GUI task, websocket events, power events) never block,
+ * messages are taken by sender task in priority order (FIFO within the same priority). Queued message with the same
+ * merge key is replaced by newer one, messages which aren't sent before their deadline are dropped.
+ **/
+class WebsocketOutboundQueue
+{
+public:
+    WebsocketOutboundQueue();
+    /**
+     * @brief Copies text into new message and queues it
+     * @return false if queue of given priority is full (callback is invoked with false)
+     **/
+    bool push(const char *text, int length, OutboundPriority_t priority, OutboundMergeKey_t merge_key, uint32_t timeout_ms, send_callback callback);
+    /// Waits for next message that hasn't expired yet, returned message must be released by complete()
+    OutboundMessage_t *pop(TickType_t wait);
+    /// Invokes message callback and releases the message
+    static void complete(OutboundMessage_t *message, bool sent);
+    /// Drops all queued messages (callbacks are invoked with false)
+    void clear();
+    uint32_t get_dropped_count() { return dropped_; }
+    uint32_t get_expired_count() { return expired_; }
+    uint32_t get_merged_count() { return merged_; }
+
+private:
+    std::deque<OutboundMessage_t *> queues_[WS_PRIORITY_COUNT];
+    SemaphoreHandle_t lock_;
+    SemaphoreHandle_t available_;
+    uint32_t dropped_ = 0;
+    uint32_t expired_ = 0;
+    uint32_t merged_ = 0;
+};
@@ -8,7 +8,7 @@ Configurable::Configurable(String path)
 
 void Configurable::load()
 {
-    StaticJsonDocument<512> doc;
+    SpiRamJsonDocument doc(CONFIG_JSON_SIZE);
     auto exists = SPIFFS.exists(file_path);
     ESP_LOGI(TAG, "Loading config %s (exists=%d)", file_path.c_str(), exists);
 
@@ -32,7 +32,7 @@ void Configurable::load()
 
 void Configurable::save()
 {
-    StaticJsonDocument<512> doc;
+    SpiRamJsonDocument doc(CONFIG_JSON_SIZE);
     auto file = SPIFFS.open(file_path, "w");
     JsonObject obj = doc.createNestedObject("root");
     save_config_to_file(obj);
@@ -3,6 +3,8 @@
 #include <ArduinoJson.h>
 #include "json.h"
 
+#define CONFIG_JSON_SIZE 2048 // websocket config holds token and known servers, wifi config known networks with cached AP and lease
+
 class Configurable
 {
     public:
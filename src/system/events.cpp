@@ -1,15 +1,34 @@
 #include "events.h"
+#include "value_coalescer.h"
+#include "hardware/hardware.h"
+#include "esp_log.h"
+#include <atomic>
+
+static const char *EVENTS_TAG = "EVENTS";
 
 QueueHandle_t g_event_queue_handle = NULL;
 EventGroupHandle_t g_app_state = NULL;
-QueueHandle_t gui_queue_handle = NULL;
+static SignalKValueCoalescer gui_values;
+// number of pending warnings of every message code (repeated warning is shown with its count)
+static std::atomic<uint32_t> pending_warnings[GUI_MESSAGE_CODE_COUNT];
+
+struct PendingTextWarning_t
+{
+    char *text; // malloc'ed copy, slot is free if NULL
+    uint32_t count;
+};
+
+// producers only fill free slots or count repeats, slots are released only by GUI task (read_gui_update)
+static PendingTextWarning_t pending_texts[GUI_TEXT_WARNING_MAX];
+static portMUX_TYPE pending_texts_lock = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> gui_warnings_dropped(0);
 
 void initialize_events()
 {
     //Create a program that allows the required message objects and group flags
     g_event_queue_handle = xQueueCreate(20, sizeof(uint8_t));
-    gui_queue_handle = xQueueCreate(60, sizeof(GuiEvent_t));
     g_app_state = xEventGroupCreate();
+    gui_values.init();
 }
 
 void post_event(ApplicationEvents_T event)
@@ -17,50 +36,182 @@ void post_event(ApplicationEvents_T event)
     xQueueSend(g_event_queue_handle, &event, 10);
 }
 
-void post_gui_update(GuiEvent_t event)
+static void wake_up_for_warning()
 {
-    if (event.event_type == GuiEventType_t::GUI_SHOW_WARNING && is_low_power())
+    if (is_low_power())
     {
         xEventGroupSetBits(g_app_state, G_APP_STATE_WAKE_UP);
+        wakeup_from_task();
     }
-    
-    xQueueSend(gui_queue_handle, &event, 10);
 }
 
 void post_gui_warning(GuiMessageCode_t code)
 {
-    GuiEvent_t event;
-    event.event_type = GuiEventType_t::GUI_SHOW_WARNING;
-    event.message_code = code;
-    event.argument = NULL;
+    if (code <= GuiMessageCode_t::NONE || code >= GUI_MESSAGE_CODE_COUNT)
+    {
+        return;
+    }
+
+    // coded warnings are only counted, so they are never lost nor do they take room in the text list
+    pending_warnings[code]++;
+    wake_up_for_warning();
+}
+
+bool post_gui_warning(const String& message)
+{
+    // allocation isn't allowed in critical section, copy is freed if the text is already pending
+    char *text = (char *)malloc(message.length() + 1);
+    bool posted = false;
+    bool repeated = false;
+
+    if (text == NULL)
+    {
+        gui_warnings_dropped++;
+        return false;
+    }
+    strcpy(text, message.c_str());
+
+    // sender is often websocket or event loop task, it must not wait for GUI task
+    portENTER_CRITICAL(&pending_texts_lock);
+    for (int i = 0; i < GUI_TEXT_WARNING_MAX && !posted; i++)
+    {
+        if (pending_texts[i].text != NULL && strcmp(pending_texts[i].text, text) == 0)
+        {
+            pending_texts[i].count++;
+            posted = true;
+            repeated = true;
+        }
+    }
+    for (int i = 0; i < GUI_TEXT_WARNING_MAX && !posted; i++)
+    {
+        if (pending_texts[i].text == NULL)
+        {
+            pending_texts[i].text = text;
+            pending_texts[i].count = 1;
+            posted = true;
+        }
+    }
+    portEXIT_CRITICAL(&pending_texts_lock);
+
+    if (!posted || repeated)
+    {
+        free(text);
+    }
+
+    if (posted)
+    {
+        wake_up_for_warning();
+    }
+    else
+    {
+        gui_warnings_dropped++;
+        ESP_LOGW(EVENTS_TAG, "%d text warnings are pending, warning not posted (%u so far)", GUI_TEXT_WARNING_MAX,
+                 gui_warnings_dropped.load());
+    }
 
-    post_gui_update(event);
+    return posted;
 }
 
-void post_gui_warning(const String& message)
+/// Takes next pending text warning, it's called only from GUI task
+static bool read_text_warning(GuiEvent_t &event)
 {
-    GuiEvent_t event;
-    event.argument = malloc(message.length() + 1);
-    strcpy((char *)event.argument, message.c_str());
+    char *text = NULL;
+    bool copy = false;
+    int slot = 0;
+
+    portENTER_CRITICAL(&pending_texts_lock);
+    for (int i = 0; i < GUI_TEXT_WARNING_MAX && text == NULL; i++)
+    {
+        if (pending_texts[i].text != NULL)
+        {
+            slot = i;
+            text = pending_texts[i].text;
+            if (pending_texts[i].count > 1)
+            {
+                // slot keeps the text for remaining repeats, only this task can release it
+                pending_texts[i].count--;
+                copy = true;
+            }
+            else
+            {
+                pending_texts[i].text = NULL;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&pending_texts_lock);
+
+    if (text == NULL)
+    {
+        return false;
+    }
+
+    if (copy)
+    {
+        text = strdup(text);
+        if (text == NULL)
+        {
+            // give the repeat back, it's shown next time
+            portENTER_CRITICAL(&pending_texts_lock);
+            pending_texts[slot].count++;
+            portEXIT_CRITICAL(&pending_texts_lock);
+            return false;
+        }
+    }
+
     event.event_type = GuiEventType_t::GUI_SHOW_WARNING;
     event.message_code = GuiMessageCode_t::NONE;
-    post_gui_update(event);
+    event.argument = text;
+
+    return true;
 }
 
-void post_gui_sk_dv_update(const String& json)  // "sk_dv" means "SignalK DynamicView"
+/** Posts typed SignalK value update to GUI. Only the latest value of every path is kept until GUI task reads it,
+ * so fast updates of the same path are coalesced instead of filling the queue. It can be called from any task.
+ */
+void post_gui_sk_dv_update(const SignalKUpdate_t& update, char *spill)  // "sk_dv" means "SignalK DynamicView"
 {
-    GuiEvent_t event;
-    event.argument = malloc(json.length() + 1);
-    strcpy((char *)event.argument, json.c_str());
-    event.event_type = GuiEventType_t::GUI_SK_DV_UPDATE;
-    event.message_code = GuiMessageCode_t::NONE;
+    gui_values.post(update, spill);
+}
 
-    post_gui_update(event);
+/// Reads latest value of next updated path, it must be called only from LVGL task
+bool read_gui_sk_dv_update(SignalKUpdate_t& update, char **spill)
+{
+    return gui_values.read(update, spill);
+}
+
+uint32_t get_gui_sk_dv_coalesced_count()
+{
+    return gui_values.get_coalesced_count();
+}
+
+uint32_t get_gui_sk_dv_delivered_count()
+{
+    return gui_values.get_delivered_count();
+}
+
+uint32_t get_gui_warnings_dropped_count()
+{
+    return gui_warnings_dropped;
 }
 
 bool read_gui_update(GuiEvent_t &event)
 {
-    return xQueueReceive(gui_queue_handle, &event, 10);
+    for (int code = GuiMessageCode_t::NONE + 1; code < GUI_MESSAGE_CODE_COUNT; code++)
+    {
+        uint32_t pending = pending_warnings[code].load();
+        while (pending > 0)
+        {
+            if (pending_warnings[code].compare_exchange_weak(pending, pending - 1))
+            {
+                event.event_type = GuiEventType_t::GUI_SHOW_WARNING;
+                event.message_code = (GuiMessageCode_t)code;
+                event.argument = NULL;
+                return true;
+            }
+        }
+    }
+
+    return read_text_warning(event);
 }
 
 bool is_low_power()
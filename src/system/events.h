@@ -6,12 +6,15 @@
 #include <freertos/queue.h>
 #include <freertos/event_groups.h>
 #include "Arduino.h"
+#include "networking/signalk_value.h"
 
 #define G_EVENT_VBUS_PLUGIN _BV(0)
 #define G_EVENT_VBUS_REMOVE _BV(1)
 #define G_EVENT_CHARGE_DONE _BV(2)
 #define G_EVENT_TOUCH _BV(3)
 
+#define GUI_TEXT_WARNING_MAX 16 // different text warnings waiting for GUI task, repeated text is only counted
+
 #define G_APP_STATE_LOW_POWER _BV(0)
 #define G_APP_STATE_WAKE_UP _BV(1)
 
@@ -24,8 +27,7 @@ enum ApplicationEvents_T
 
 enum GuiEventType_t
 {
-    GUI_SHOW_WARNING,
-    GUI_SK_DV_UPDATE  // SK_DV means "SignalK DynamicView"
+    GUI_SHOW_WARNING
 };
 
 enum GuiMessageCode_t
@@ -35,7 +37,8 @@ enum GuiMessageCode_t
     GUI_WARN_SK_LOST_CONNECTION,
     GUI_WARN_WIFI_DISCONNECTED,
     GUI_WARN_WIFI_CONNECTION_FAILED,
-    GUI_INFO_BATTERY_CHARGE_COMPLETE
+    GUI_INFO_BATTERY_CHARGE_COMPLETE,
+    GUI_MESSAGE_CODE_COUNT
 };
 
 struct GuiEvent_t
@@ -50,9 +53,22 @@ extern EventGroupHandle_t g_app_state;
 
 void initialize_events();
 void post_event(ApplicationEvents_T event);
-void post_gui_sk_dv_update(const String& json);  // "sk_dv" means "SignalK DynamicView"
+/// Spill is raw JSON of value which doesn't fit into SignalKValue_t (allocated by psram_malloc), it's owned by the queue
+void post_gui_sk_dv_update(const SignalKUpdate_t& update, char *spill = NULL);  // "sk_dv" means "SignalK DynamicView"
+/// Spill (if set) is owned by the caller and freed by psram_free
+bool read_gui_sk_dv_update(SignalKUpdate_t& update, char **spill);
+uint32_t get_gui_sk_dv_coalesced_count();
+uint32_t get_gui_sk_dv_delivered_count();
+/// Text warnings which couldn't be posted because GUI_TEXT_WARNING_MAX different texts were already waiting
+uint32_t get_gui_warnings_dropped_count();
+/// Coded warnings (connection, battery) are never lost, they are counted per code until GUI task reads them
 void post_gui_warning(GuiMessageCode_t message);
-void post_gui_warning(const String& message);
+/**
+ * Text warnings (SignalK notifications, mDNS errors) wait in bounded pending list without blocking the caller,
+ * repeated text is counted like coded warnings. Posted warning is never dropped.
+ * @return false if the list is full (caller can post it again later, e.g. with next notification delta)
+ **/
+bool post_gui_warning(const String& message);
 bool read_gui_update(GuiEvent_t& event);
 bool is_low_power();
 void set_low_power(bool low_power);
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "low_power_scheduler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *SCHEDULER_TAG = "LP_JOBS";
+/// Estimated current in mA when job of given class runs (ESP32 at 80 MHz, Wifi TX, SPI flash write)
+static const uint32_t power_class_current_ma[POWER_CLASS_COUNT] = {30, 120, 45};
+static const char *power_class_names[POWER_CLASS_COUNT] = {"cpu", "radio", "flash"};
+
+LowPowerScheduler::LowPowerScheduler()
+{
+    lock_ = xSemaphoreCreateMutex();
+}
+
+int LowPowerScheduler::add(const char *name, uint32_t period_ms, uint32_t delay_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job)
+{
+    int ret = -1;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < LOW_POWER_JOBS_MAX; i++)
+    {
+        if (!used_[i])
+        {
+            auto &entry = jobs_[i];
+            entry = LowPowerJob_t();
+            entry.name = name;
+            entry.period_ms = period_ms;
+            entry.delay_ms = delay_ms;
+            entry.slack_ms = slack_ms;
+            entry.power_class = power_class;
+            entry.job = job;
+            // job added while the watch sleeps is scheduled from now, otherwise start() schedules it
+            entry.due_us = esp_timer_get_time() + delay_ms * 1000LL;
+            used_[i] = true;
+            generation_[i]++;
+            ret = i;
+            break;
+        }
+    }
+    xSemaphoreGive(lock_);
+
+    if (ret < 0)
+    {
+        ESP_LOGE(SCHEDULER_TAG, "No free slot for job %s!", name);
+    }
+
+    return ret;
+}
+
+int LowPowerScheduler::add_job(const char *name, uint32_t period_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job)
+{
+    return add(name, period_ms, period_ms, slack_ms, power_class, job);
+}
+
+int LowPowerScheduler::add_one_shot(const char *name, uint32_t delay_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job)
+{
+    return add(name, 0, delay_ms, slack_ms, power_class, job);
+}
+
+void LowPowerScheduler::remove_job(int id)
+{
+    if (id >= 0 && id < LOW_POWER_JOBS_MAX)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        used_[id] = false;
+        generation_[id]++;
+        jobs_[id].job = nullptr;
+        xSemaphoreGive(lock_);
+    }
+}
+
+void LowPowerScheduler::start(int64_t now_us)
+{
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < LOW_POWER_JOBS_MAX; i++)
+    {
+        if (used_[i])
+        {
+            jobs_[i].due_us = now_us + jobs_[i].delay_ms * 1000LL;
+        }
+    }
+    xSemaphoreGive(lock_);
+}
+
+int64_t LowPowerScheduler::get_next_deadline()
+{
+    int64_t ret = LOW_POWER_NO_DEADLINE;
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < LOW_POWER_JOBS_MAX; i++)
+    {
+        if (used_[i])
+        {
+            // waking up at the end of the window gives other jobs the best chance to join the batch
+            int64_t deadline = jobs_[i].due_us + jobs_[i].slack_ms * 1000LL;
+            if (deadline < ret)
+            {
+                ret = deadline;
+            }
+        }
+    }
+    xSemaphoreGive(lock_);
+
+    return ret;
+}
+
+int LowPowerScheduler::run_due(int64_t now_us)
+{
+    int ret = 0;
+
+    for (int i = 0; i < LOW_POWER_JOBS_MAX; i++)
+    {
+        low_power_job job = nullptr;
+        uint32_t generation = 0;
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        if (used_[i] && jobs_[i].due_us <= now_us)
+        {
+            job = jobs_[i].job;
+            generation = generation_[i];
+        }
+        xSemaphoreGive(lock_);
+
+        if (job == nullptr)
+        {
+            continue;
+        }
+
+        // job runs without the lock, so it can add or remove jobs
+        auto start = esp_timer_get_time();
+        job();
+        auto run_time = esp_timer_get_time() - start;
+        ret++;
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        if (!used_[i] || generation_[i] != generation)
+        {
+            // job removed itself (or was removed) while running and the slot may hold another job now
+            xSemaphoreGive(lock_);
+            continue;
+        }
+        auto &entry = jobs_[i];
+        entry.runs++;
+        entry.run_time_us += run_time;
+        if (entry.period_ms == 0)
+        {
+            used_[i] = false;
+            generation_[i]++;
+            entry.job = nullptr;
+        }
+        else
+        {
+            entry.due_us += entry.period_ms * 1000LL;
+            if (entry.due_us <= now_us)
+            {
+                entry.due_us = now_us + entry.period_ms * 1000LL;
+            }
+        }
+        xSemaphoreGive(lock_);
+    }
+
+    if (ret > 0)
+    {
+        batches_++;
+        ESP_LOGD(SCHEDULER_TAG, "Executed %d jobs in one wakeup.", ret);
+    }
+
+    return ret;
+}
+
+void LowPowerScheduler::log_stats()
+{
+    ESP_LOGI(SCHEDULER_TAG, "Low power jobs since boot, %u wakeups with jobs:", batches_);
+
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    for (int i = 0; i < LOW_POWER_JOBS_MAX; i++)
+    {
+        auto &entry = jobs_[i];
+        if (entry.runs > 0)
+        {
+            // mA * us -> uAh
+            uint32_t charge_uah = (uint32_t)(power_class_current_ma[entry.power_class] * entry.run_time_us / 3600000ULL);
+            ESP_LOGI(SCHEDULER_TAG, "  %-16s %-5s runs=%u time=%u ms charge=%u uAh", entry.name, power_class_names[entry.power_class],
+                     entry.runs, (uint32_t)(entry.run_time_us / 1000), charge_uah);
+        }
+    }
+    xSemaphoreGive(lock_);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define LOW_POWER_JOBS_MAX 16
+#define LOW_POWER_NO_DEADLINE INT64_MAX
+
+/// What the job mostly powers, used to estimate energy used by the job
+enum PowerClass_t
+{
+    POWER_CLASS_CPU,   // computation only
+    POWER_CLASS_RADIO, // sends or receives data over Wifi
+    POWER_CLASS_FLASH, // writes into SPIFFS
+    POWER_CLASS_COUNT
+};
+
+typedef std::function<void(void)> low_power_job;
+
+struct LowPowerJob_t
+{
+    const char *name = NULL;
+    uint32_t period_ms = 0; // 0 = one-shot job
+    uint32_t delay_ms = 0;  // first run after start, equals period_ms for periodic jobs
+    uint32_t slack_ms = 0;  // how long the job can be delayed after it's due, so it can run together with other jobs
+    PowerClass_t power_class = POWER_CLASS_CPU;
+    low_power_job job;
+    int64_t due_us = 0;
+    uint32_t runs = 0;
+    uint64_t run_time_us = 0;
+};
+
+/**
+ * @brief Runs periodic and one-shot jobs while the watch sleeps in low power mode. Each job has a window
+ * (due time + slack), sleep loop wakes up at the earliest end of a window and runs all jobs that are due by then,
+ * so jobs with overlapping windows share a single CPU wakeup. Jobs are executed from sleep loop (Hardware task).
+ * Run time and estimated charge of every job are kept for power analysis.
+ **/
+class LowPowerScheduler
+{
+public:
+    LowPowerScheduler();
+    /// Registers periodic job (from any task), returns job ID or -1 if there is no free slot
+    int add_job(const char *name, uint32_t period_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job);
+    /// Registers job that runs once after delay_ms of low power mode
+    int add_one_shot(const char *name, uint32_t delay_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job);
+    void remove_job(int id);
+    /// Schedules all jobs (periodic and one-shot) from now, called when watch enters low power mode
+    void start(int64_t now_us);
+    /// Returns time (esp_timer_get_time) when CPU has to wake up, LOW_POWER_NO_DEADLINE if there are no jobs
+    int64_t get_next_deadline();
+    /// Runs all jobs that are due, returns number of executed jobs
+    int run_due(int64_t now_us);
+    /// Logs run count, run time and estimated charge of every job
+    void log_stats();
+    uint32_t get_batch_count() { return batches_; }
+
+private:
+    LowPowerJob_t jobs_[LOW_POWER_JOBS_MAX];
+    bool used_[LOW_POWER_JOBS_MAX] = {false};
+    /// incremented whenever a slot is added or removed, so run_due doesn't update a slot reused while its job ran
+    uint32_t generation_[LOW_POWER_JOBS_MAX] = {0};
+    uint32_t batches_ = 0;
+    SemaphoreHandle_t lock_;
+
+    int add(const char *name, uint32_t period_ms, uint32_t delay_ms, uint32_t slack_ms, PowerClass_t power_class, low_power_job job);
+};
@@ -0,0 +1,77 @@
+#include "pipeline_stats.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "psram.h"
+
+static const char *STATS_TAG = "STATS";
+static const char *stage_names[STAGE_COUNT] = {"parse", "queue", "render", "put", "replay"};
+static LatencyHistogram_t histograms[STAGE_COUNT];
+
+void pipeline_stats_record(PipelineStage_t stage, uint32_t latency_us)
+{
+    auto &histogram = histograms[stage];
+    int bucket = 0;
+
+    while (bucket < PIPELINE_HISTOGRAM_BUCKETS - 1 && latency_us >= (1u << bucket))
+    {
+        bucket++;
+    }
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.total_us += latency_us;
+    if (latency_us > histogram.max_us)
+    {
+        histogram.max_us = latency_us;
+    }
+}
+
+void pipeline_stats_reset()
+{
+    memset(histograms, 0, sizeof(histograms));
+}
+
+uint32_t pipeline_stats_percentile(PipelineStage_t stage, int percentile)
+{
+    auto &histogram = histograms[stage];
+    uint32_t target = (uint32_t)(((uint64_t)histogram.count * percentile + 99) / 100);
+    uint32_t sum = 0;
+
+    for (int i = 0; i < PIPELINE_HISTOGRAM_BUCKETS; i++)
+    {
+        sum += histogram.buckets[i];
+        if (sum >= target && sum > 0)
+        {
+            return 1u << i;
+        }
+    }
+
+    return 0;
+}
+
+const LatencyHistogram_t &pipeline_stats_get(PipelineStage_t stage)
+{
+    return histograms[stage];
+}
+
+void pipeline_stats_log(const char *title)
+{
+    ESP_LOGI(STATS_TAG, "%s", title);
+
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        auto stage = (PipelineStage_t)i;
+        auto &histogram = histograms[i];
+        ESP_LOGI(STATS_TAG, "%-6s n=%u p50<%u us p99<%u us max=%u us avg=%u us", stage_names[i], histogram.count,
+                 pipeline_stats_percentile(stage, 50), pipeline_stats_percentile(stage, 99), histogram.max_us,
+                 histogram.count > 0 ? (uint32_t)(histogram.total_us / histogram.count) : 0);
+    }
+
+    ESP_LOGI(STATS_TAG, "Heap min free: internal=%u B, PSRAM=%u B", heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+             heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+
+    uint32_t fallback_count, fallback_bytes;
+    twatchsk::psram_get_fallback_stats(fallback_count, fallback_bytes);
+    ESP_LOGI(STATS_TAG, "PSRAM fallback: %u allocations (%u B) in internal RAM", fallback_count, fallback_bytes);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+/// Stages of SignalK value ingest pipeline measured by pipeline stats
+enum PipelineStage_t
+{
+    STAGE_PARSE,  // websocket message parsing including posting of values (websocket task)
+    STAGE_QUEUE,  // time value waited in GUI value slot (from post to read by GUI task)
+    STAGE_RENDER, // dispatch of value to bound components (GUI task)
+    STAGE_PUT_RTT, // PUT request round trip (from queuing to COMPLETED response), recorded on GUI task
+    STAGE_REPLAY, // parsing of replayed message including posting of values (replay task, see SignalKCapture)
+    STAGE_COUNT
+};
+
+#define PIPELINE_HISTOGRAM_BUCKETS 24 // bucket i holds latencies < 2^i us, so last bucket is ~8 s
+
+/**
+ * @brief Latency histogram with power of 2 buckets (in microseconds). It has fixed size and record() is just a few
+ * instructions, so it can stay in production code. Every stage is recorded only from one task.
+ **/
+struct LatencyHistogram_t
+{
+    uint32_t buckets[PIPELINE_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+void pipeline_stats_record(PipelineStage_t stage, uint32_t latency_us);
+void pipeline_stats_reset();
+/// Returns upper bound (us) of bucket where given percentile (0 - 100) of recorded latencies falls
+uint32_t pipeline_stats_percentile(PipelineStage_t stage, int percentile);
+const LatencyHistogram_t &pipeline_stats_get(PipelineStage_t stage);
+/// Logs p50 / p99 / max of all stages together with heap high-water marks and PSRAM fallback allocations
+void pipeline_stats_log(const char *title);
@@ -0,0 +1,29 @@
+#include "psram.h"
+#include <atomic>
+#include "esp_log.h"
+
+static const char *PSRAM_TAG = "PSRAM";
+static std::atomic<uint32_t> fallback_count(0);
+static std::atomic<uint32_t> fallback_bytes(0);
+
+namespace twatchsk
+{
+    void psram_record_fallback(size_t size, bool ok)
+    {
+        uint32_t count = ++fallback_count;
+        fallback_bytes += (uint32_t)size;
+
+        // full PSRAM tends to stay full, so don't flood the log with every allocation
+        if ((count & (count - 1)) == 0 || !ok)
+        {
+            ESP_LOGW(PSRAM_TAG, "PSRAM is full, %u B allocated in internal RAM (%s), %u fallback allocations so far", (uint32_t)size,
+                     ok ? "ok" : "failed", count);
+        }
+    }
+
+    void psram_get_fallback_stats(uint32_t &count, uint32_t &bytes)
+    {
+        count = fallback_count;
+        bytes = fallback_bytes;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+/**
+ * Large buffers (JSON documents, websocket messages, value slots) are placed in PSRAM so internal RAM isn't fragmented.
+ * Internal RAM is used when PSRAM is full (also by SpiRamJsonDocument, see json.h), such allocations are counted
+ * (see psram_get_fallback_stats and pipeline_stats_log) and logged only at 1st, 2nd, 4th, 8th... occurrence.
+ * This is the only place where networking and GUI core touch ESP heap API, so the core can be compiled off-target
+ * (without ESP_PLATFORM it uses standard heap, see tools/host).
+ */
+namespace twatchsk
+{
+    /// Counts allocation which had to fall back to internal RAM, it's called only when PSRAM is full
+    void psram_record_fallback(size_t size, bool ok);
+    /// Returns number of allocations which fell back to internal RAM and number of their bytes since boot
+    void psram_get_fallback_stats(uint32_t &count, uint32_t &bytes);
+
+    inline void *psram_malloc(size_t size)
+    {
+#ifdef ESP_PLATFORM
+        void *ret = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+        if (ret == NULL)
+        {
+            ret = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+            psram_record_fallback(size, ret != NULL);
+        }
+        return ret;
+#else
+        return malloc(size);
+#endif
+    }
+
+    inline void *psram_calloc(size_t count, size_t size)
+    {
+#ifdef ESP_PLATFORM
+        void *ret = heap_caps_calloc(count, size, MALLOC_CAP_SPIRAM);
+        if (ret == NULL)
+        {
+            ret = heap_caps_calloc(count, size, MALLOC_CAP_8BIT);
+            psram_record_fallback(count * size, ret != NULL);
+        }
+        return ret;
+#else
+        return calloc(count, size);
+#endif
+    }
+
+    inline void psram_free(void *pointer)
+    {
+#ifdef ESP_PLATFORM
+        heap_caps_free(pointer);
+#else
+        free(pointer);
+#endif
+    }
+}
@@ -0,0 +1,50 @@
+#include "request_id.h"
+#include <atomic>
+#include "esp_system.h"
+
+static const char hex_digits[] = "0123456789abcdef";
+// 0 = not generated yet, esp_random gives true random numbers only with Wifi (or BT) running, which isn't
+// the case at static initialization, so prefix is generated with the first ID (requests are sent over Wifi)
+static std::atomic<uint32_t> request_id_prefix(0);
+static std::atomic<uint32_t> request_id_counter(0);
+
+static uint32_t get_prefix()
+{
+    uint32_t prefix = request_id_prefix.load();
+
+    if (prefix == 0)
+    {
+        uint32_t expected = 0;
+        do
+        {
+            prefix = esp_random();
+        } while (prefix == 0);
+
+        // if another task was faster, its prefix is used
+        if (!request_id_prefix.compare_exchange_strong(expected, prefix))
+        {
+            prefix = expected;
+        }
+    }
+
+    return prefix;
+}
+
+static void write_hex(char *out, uint32_t value)
+{
+    for (int i = 7; i >= 0; i--)
+    {
+        out[i] = hex_digits[value & 0xF];
+        value >>= 4;
+    }
+}
+
+void twatchsk::new_request_id(char *out)
+{
+    auto counter = request_id_counter.fetch_add(1);
+
+    write_hex(out, get_prefix());
+    out[8] = '-';
+    write_hex(out + 9, counter);
+    out[REQUEST_ID_LEN] = '\0';
+}
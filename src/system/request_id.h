@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+#define REQUEST_ID_LEN 17                    // "pppppppp-cccccccc" - boot prefix and counter in hex
+#define REQUEST_ID_STR_LEN (REQUEST_ID_LEN + 1) // with terminator
+
+/**
+ * IDs of PUT and access requests. They have to be unique only among requests of this client on the server,
+ * so random prefix generated once per boot (with the first ID, when Wifi provides entropy) is followed by counter. Formatting doesn't use heap or snprintf
+ * and it's safe to call from any task. UUID is used only for persistent clientId.
+ */
+namespace twatchsk
+{
+    /// Writes new request ID into out buffer of REQUEST_ID_STR_LEN bytes
+    void new_request_id(char *out);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free single producer / single consumer ring buffer of fixed size records.
+ * Only one task may call push() and only one (other) task may call pop(). Records are copied in place,
+ * nothing is allocated on heap. One slot is always kept empty, so ring holds up to N - 1 records.
+ **/
+template <class T, size_t N>
+class SpscRing
+{
+public:
+    /// Copies item into ring, returns false (and counts drop) if ring is full
+    bool push(const T &item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t next = (head + 1) % N;
+
+        if (next == tail_.load(std::memory_order_acquire))
+        {
+            dropped_++;
+            return false;
+        }
+
+        items_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// Copies oldest item out of the ring, returns false if ring is empty
+    bool pop(T &item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail == head_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = items_[tail];
+        tail_.store((tail + 1) % N, std::memory_order_release);
+        return true;
+    }
+
+    size_t size()
+    {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return (head + N - tail) % N;
+    }
+
+    uint32_t get_dropped_count() { return dropped_; }
+
+private:
+    T items_[N];
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    uint32_t dropped_ = 0;
+};
@@ -8,6 +8,15 @@ class UUID
 {
 public:
     static const String new_id()
+    {
+        char out[UUID_STR_LEN];
+        new_id(out);
+
+        return String(out);
+    }
+
+    /// Writes new UUID into out buffer of UUID_STR_LEN bytes
+    static void new_id(char *out)
     {
         uint8_t id[UUID_BYTE_LEN];
         /* generate idID bytes */
@@ -16,14 +25,11 @@ public:
         id[6] = 0x40 | (id[6] & 0xF);
         /* idid variant */
         id[8] = (0x80 | id[8]) & ~0x40;
-        static char out[37];
         snprintf(out, UUID_STR_LEN,
                  "%02x%02x%02x%02x-%02x%02x-%02x%02x-"
                  "%02x%02x-%02x%02x%02x%02x%02x%02x",
                  id[0], id[1], id[2], id[3], id[4], id[5], id[6], id[7], id[8], id[9], id[10], id[11],
                  id[12], id[13], id[14], id[15]);
-
-        return String(out);
     }
 
 private:
@@ -0,0 +1,81 @@
+#include "value_coalescer.h"
+#include "psram.h"
+#include "pipeline_stats.h"
+#include "esp_timer.h"
+
+SignalKValueCoalescer::~SignalKValueCoalescer()
+{
+    if (slots_ != NULL)
+    {
+        for (int i = 0; i < SK_PATH_INDEX_MAX; i++)
+        {
+            twatchsk::psram_free(slots_[i].spill);
+        }
+
+        twatchsk::psram_free(slots_);
+        slots_ = NULL;
+    }
+}
+
+bool SignalKValueCoalescer::init()
+{
+    if (slots_ == NULL)
+    {
+        slots_ = (Slot_t *)twatchsk::psram_calloc(SK_PATH_INDEX_MAX, sizeof(Slot_t));
+    }
+
+    return slots_ != NULL;
+}
+
+void SignalKValueCoalescer::post(const SignalKUpdate_t &update, char *spill)
+{
+    if (update.path_id >= SK_PATH_INDEX_MAX || slots_ == NULL)
+    {
+        twatchsk::psram_free(spill);
+        return;
+    }
+
+    portENTER_CRITICAL(&mux_);
+    Slot_t &slot = slots_[update.path_id];
+    char *replaced = slot.spill;
+    slot.update = update;
+    slot.spill = spill;
+    if (slot.dirty)
+    {
+        coalesced_++;
+    }
+    else
+    {
+        slot.dirty = true;
+        slot.dirty_since_us = (uint32_t)esp_timer_get_time();
+        // push is serialized by the critical section, so ring still has single producer
+        dirty_paths_.push(update.path_id);
+    }
+    portEXIT_CRITICAL(&mux_);
+
+    // heap isn't touched inside critical section
+    twatchsk::psram_free(replaced);
+}
+
+bool SignalKValueCoalescer::read(SignalKUpdate_t &update, char **spill)
+{
+    sk_path_id_t path_id;
+
+    if (!dirty_paths_.pop(path_id))
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&mux_);
+    Slot_t &slot = slots_[path_id];
+    update = slot.update;
+    *spill = slot.spill;
+    slot.spill = NULL;
+    slot.dirty = false;
+    uint32_t dirty_since_us = slot.dirty_since_us;
+    portEXIT_CRITICAL(&mux_);
+    delivered_++;
+    pipeline_stats_record(STAGE_QUEUE, (uint32_t)esp_timer_get_time() - dirty_since_us);
+
+    return true;
+}
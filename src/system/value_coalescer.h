@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include "networking/signalk_value.h"
+#include "system/spsc_ring.h"
+
+/**
+ * @brief Latest value of every interned path waiting for GUI task. Only the latest value of a path is kept until
+ * it's read, so fast updates of the same path are coalesced instead of filling a queue, and paths are read in order
+ * they became dirty. Values which don't fit into SignalKValue_t (long strings, large objects) are spilled to heap
+ * as raw JSON text, slot owns the text until the reader takes it.
+ * Values can be posted from any task, but they are read only from one task (GUI).
+ **/
+class SignalKValueCoalescer
+{
+public:
+    ~SignalKValueCoalescer();
+    /// Allocates slots (in PSRAM if available)
+    bool init();
+    /**
+     * @brief Stores latest value of the path
+     * @param spill raw JSON text of value with type SK_VALUE_SPILLED allocated by psram_malloc, it's owned by the coalescer
+     **/
+    void post(const SignalKUpdate_t &update, char *spill = NULL);
+    /**
+     * @brief Reads latest value of next updated path
+     * @param spill receives raw JSON text of spilled value (NULL otherwise), caller owns it and frees it by psram_free
+     **/
+    bool read(SignalKUpdate_t &update, char **spill);
+    uint32_t get_coalesced_count() { return coalesced_; }
+    uint32_t get_delivered_count() { return delivered_; }
+
+private:
+    struct Slot_t
+    {
+        SignalKUpdate_t update;
+        char *spill;
+        bool dirty;
+        uint32_t dirty_since_us; // time when slot became dirty, used for queue latency stats
+    };
+
+    Slot_t *slots_ = NULL;
+    portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+    // IDs of paths with dirty slot in order they were updated, every path is there at most once so ring never overflows
+    SpscRing<sk_path_id_t, SK_PATH_INDEX_MAX + 1> dirty_paths_;
+    uint32_t coalesced_ = 0;
+    uint32_t delivered_ = 0;
+};
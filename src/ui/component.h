@@ -5,9 +5,18 @@
 class Component
 {
     public:
+        virtual ~Component() { }
         void virtual load(const JsonObject &json);
         void virtual update(const JsonVariant &update);
         void virtual on_offline() { }
+        /// Stale component shows last known (cached) value which hasn't been confirmed by live data yet
+        void virtual set_stale(bool stale)
+        {
+            if (obj_ != NULL)
+            {
+                lv_obj_set_style_local_opa_scale(obj_, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, stale ? LV_OPA_50 : LV_OPA_COVER);
+            }
+        }
         void virtual destroy();
         lv_obj_t* get_obj()
         {
@@ -22,4 +22,32 @@ DataAdapter::DataAdapter(Component*target)
     targetObject_ = target;
     sk_put_only_ = true;
     adapters.push_back(this);
-}
\ No newline at end of file
+}
+
+JsonVariant DataAdapter::value_to_json(const SignalKValue_t &value, JsonDocument &doc)
+{
+    doc.clear();
+
+    switch (value.type)
+    {
+    case SK_VALUE_INT:
+        doc.set(value.integer);
+        break;
+    case SK_VALUE_NUMBER:
+        doc.set(value.number);
+        break;
+    case SK_VALUE_BOOL:
+        doc.set(value.boolean);
+        break;
+    case SK_VALUE_STRING:
+        doc.set((const char *)value.text);
+        break;
+    case SK_VALUE_JSON:
+        deserializeJson(doc, (const char *)value.text);
+        break;
+    default:
+        break;
+    }
+
+    return doc.as<JsonVariant>();
+}
@@ -5,7 +5,12 @@
 #include "component.h"
 #include <vector>
 #include "networking/signalk_socket.h"
-#include "system/uuid.h"
+#include "networking/signalk_path_index.h"
+#include "networking/signalk_value.h"
+#include "system/request_id.h"
+
+// spilled value is longer than SK_VALUE_TEXT_MAX by definition, typical ones (position with altitude, attitude) fit
+#define DATA_ADAPTER_PENDING_SPILL_MAX (SK_VALUE_TEXT_MAX * 2)
 
 struct Data_formating_t
 {
@@ -21,52 +26,144 @@ public:
     DataAdapter(String sk_path, int sk_subscription_period, Component *target);
     DataAdapter(Component *target);
     const String &get_path() { return path; }
+    sk_path_id_t get_path_id() { return path_id_; }
+    /**
+     * @brief Loads optional subscription options of the binding:
+     * "policy" - instant / ideal / fixed and "minPeriod" - minimum ms between updates with instant policy
+     **/
+    void load_binding_options(const JsonObject &binding)
+    {
+        if (binding.containsKey("policy"))
+        {
+            policy_ = SignalKSubscription::policy_from_string(binding["policy"].as<String>());
+        }
+
+        if (binding.containsKey("minPeriod"))
+        {
+            min_period_ = binding["minPeriod"].as<uint>();
+        }
+    }
+
+    /// Index of dynamic view the target component belongs to, it must be set before initialize()
+    void set_view(int view) { view_ = view; }
     int get_subscription_period() { return subscription_period; }
-    void on_updated(const JsonVariant &value)
+    /**
+     * @brief Updates target component if it's visible, otherwise only latest value is stored
+     * and component will be updated once when it becomes visible (see set_visible)
+     **/
+    void on_updated(const SignalKValue_t &value, const char *spill = NULL)
     {
-        targetObject_->update(value);
+        has_value_ = true;
+        set_stale(false);
+
+        if (visible_)
+        {
+            if (spill != NULL)
+            {
+                // value too large for SignalKValue_t is rare, so document is allocated just for it
+                SpiRamJsonDocument json(strlen(spill) * 2 + 256);
+                deserializeJson(json, spill);
+                targetObject_->update(json.as<JsonVariant>());
+            }
+            else
+            {
+                StaticJsonDocument<256> json;
+                targetObject_->update(value_to_json(value, json));
+            }
+        }
+        else if (spill != NULL && strlen(spill) >= DATA_ADAPTER_PENDING_SPILL_MAX)
+        {
+            // too large to keep for hidden component, it shows last value as stale until next update of the path
+            has_pending_value_ = false;
+            set_stale(true);
+        }
+        else
+        {
+            pending_value_ = value;
+            strcpy(pending_spill_, spill != NULL ? spill : "");
+            has_pending_value_ = true;
+        }
     }
 
+    /// Shows last known value from the cache, it's marked as stale until live value arrives
+    void on_cached(const SignalKValue_t &value)
+    {
+        on_updated(value);
+        set_stale(true);
+    }
+
+    /// Component keeps showing last known value (as stale) or it's cleared if it has never got any
     void on_offline()
     {
-        targetObject_->on_offline();
+        if (has_value_)
+        {
+            set_stale(true);
+        }
+        else
+        {
+            has_pending_value_ = false;
+            targetObject_->on_offline();
+        }
+    }
+
+    void set_stale(bool stale)
+    {
+        if (stale_ != stale)
+        {
+            stale_ = stale;
+            targetObject_->set_stale(stale);
+        }
     }
 
-    bool put_request(bool value)
+    void set_visible(bool visible)
     {
-        ESP_LOGI("DataAdapter", "Put request %s with bool value %s", path.c_str(), value ? "true" : "false");
-
-        DynamicJsonDocument request(1024);
-        JsonObject root = request.to<JsonObject>();
-        root["requestId"] = UUID::new_id();
-        JsonObject put_data = root.createNestedObject("put");
-        put_data["path"] = path;
-        put_data["value"] = value;
-        
-        return put_request(root);
+        visible_ = visible;
+
+        if (visible_ && has_pending_value_)
+        {
+            has_pending_value_ = false;
+            on_updated(pending_value_, pending_value_.type == SK_VALUE_SPILLED ? pending_spill_ : NULL);
+            pending_spill_[0] = '\0';
+        }
     }
 
-    bool put_request(String value)
+    /**
+     * @brief Sends pre-serialized PUT request with new requestId, it doesn't use JSON library
+     * @param request_id if set, it receives ID of the request (REQUEST_ID_STR_LEN bytes), so it can be cancelled
+     **/
+    bool put_request(SignalKPutTemplate &put_template, put_callback callback = nullptr, char *request_id = NULL)
     {
-        ESP_LOGI("DataAdapter", "Put request %s with json value %s", path.c_str(), value.c_str());
-        DynamicJsonDocument putObj(512);
-        deserializeJson(putObj, value);
-
-        DynamicJsonDocument request(1024);
-        JsonObject root = request.to<JsonObject>();
-        root["requestId"] = UUID::new_id();
-        JsonObject put_data = root.createNestedObject("put");
-        put_data["path"] = putObj["path"];
-        put_data["value"] = putObj["value"];
-        
-        return put_request(root);
+        if (!put_template.is_compiled() || ws_socket_->get_state() != WebsocketState_t::WS_Connected)
+        {
+            return false;
+        }
+
+        char new_id[REQUEST_ID_STR_LEN];
+        twatchsk::new_request_id(new_id);
+        auto text = put_template.render(new_id);
+
+        if (request_id != NULL)
+        {
+            strcpy(request_id, new_id);
+        }
+
+        return ws_socket_->send_put_request(text, put_template.get_length(), new_id, callback);
+    }
+
+    /// Callback of the PUT request won't be called (component which sent it is being destroyed)
+    void cancel_put_request(const char *request_id)
+    {
+        if (ws_socket_ != NULL)
+        {
+            ws_socket_->get_put_tracker().cancel(request_id);
+        }
     }
 
-    bool put_request(JsonObject &obj)
+    bool put_request(JsonObject &obj, put_callback callback = nullptr)
     {
         if (ws_socket_->get_state() == WebsocketState_t::WS_Connected)
         {
-            return ws_socket_->send_put_request(obj);
+            return ws_socket_->send_put_request(obj, callback);
         }
         else
         {
@@ -79,17 +176,30 @@ public:
         ws_socket_ = socket;
         if(!sk_put_only_)
         {
-            socket->add_subscription(get_path(), get_subscription_period(), false);
+            path_id_ = SignalKPathIndex::intern(path.c_str(), path.length());
+            socket->add_subscription(get_path(), get_subscription_period(), false, view_, policy_, min_period_);
         }
     }
 
     static std::vector<DataAdapter *> &get_adapters();
+    /// Stores value into (stack allocated) document so it can be passed to components
+    static JsonVariant value_to_json(const SignalKValue_t &value, JsonDocument &doc);
 
 protected:
     int subscription_period = 0;
     Data_formating_t formating_options_;
     String path = "";
+    sk_path_id_t path_id_ = SK_PATH_ID_NONE;
     Component *targetObject_ = NULL;
     SignalKSocket *ws_socket_ = NULL;
     bool sk_put_only_ = false;
+    int view_ = -1;
+    SubscriptionPolicy_t policy_ = SK_POLICY_DEFAULT;
+    uint min_period_ = 0;
+    bool visible_ = true;
+    bool has_pending_value_ = false;
+    bool has_value_ = false;
+    bool stale_ = false;
+    SignalKValue_t pending_value_;
+    char pending_spill_[DATA_ADAPTER_PENDING_SPILL_MAX] = ""; // raw JSON of pending value with type SK_VALUE_SPILLED
 };
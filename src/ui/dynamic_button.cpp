@@ -37,9 +37,8 @@ void DynamicButton::load(const JsonObject &json)
 
     if (json.containsKey("put"))
     {
-        auto push = json["put"].as<JsonObject>();      
-        serializeJson(push, sk_put_json_);
-        ESP_LOGI("BTN", "SK Put %s", sk_put_json_.c_str());
+        auto push = json["put"].as<JsonObject>();
+        put_template_.compile(push["path"].as<const char *>(), push["value"]);
         button_action_ = ButtonAction::SKPut;
         adapter_ = new DataAdapter(this);
     }
@@ -102,7 +101,19 @@ void DynamicButton::on_clicked()
 
 bool DynamicButton::send_put_request()
 {
-    return adapter_->put_request(sk_put_json_);
+    auto sent = adapter_->put_request(put_template_, [](PutResult_t result, int status_code)
+                                      {
+                                          if (result != PUT_COMPLETED)
+                                          {
+                                              post_gui_warning(result == PUT_NOT_SENT ? LOC_SK_PUT_SEND_FAIL : LOC_SK_PUT_FAILED);
+                                          }
+                                      });
+    if (!sent)
+    {
+        post_gui_warning(LOC_SK_PUT_SEND_FAIL);
+    }
+
+    return sent;
 }
 
 void DynamicButton::destroy()
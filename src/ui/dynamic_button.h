@@ -28,7 +28,7 @@ class DynamicButton : public Component
     private:
         ButtonAction button_action_; 
         lv_obj_t * label_;
-        String sk_put_json_;
+        SignalKPutTemplate put_template_;
         DataAdapter* adapter_;
 };
 
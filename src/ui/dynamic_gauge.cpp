@@ -82,7 +82,8 @@ void DynamicGauge::load(const JsonObject &json)
         }
 
         //register dataadapter that will connect SK receiver and this arc
-        new DataAdapter(binding["path"].as<String>(), period, this);
+        auto adapter = new DataAdapter(binding["path"].as<String>(), period, this);
+        adapter->load_binding_options(binding);
     }
 
     DynamicHelpers::set_location(arc, json);
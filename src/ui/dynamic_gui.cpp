@@ -6,6 +6,9 @@
 #include "networking/signalk_socket.h"
 #include "networking/signalk_subscription.h"
 #include "data_adapter.h"
+#include "networking/signalk_value_cache.h"
+#include "system/pipeline_stats.h"
+#include "esp_timer.h"
 
 #include "dynamic_label.h"
 #include "dynamic_gauge.h"
@@ -31,6 +34,7 @@ bool DynamicGui::load_file(String path, lv_obj_t *parent, SignalKSocket *socket,
 {
     bool ret = false;
     tile_view_ = parent;
+    socket_ = socket;
     SpiRamJsonDocument uiJson(20480); // allocate 20 kB in SPI RAM for JSON parsing
     DeserializationError result;
 
@@ -63,11 +67,51 @@ bool DynamicGui::load_file(String path, lv_obj_t *parent, SignalKSocket *socket,
         count = x;
         ESP_LOGI(DGUI_TAG, "Loaded %d views.", count);
 
+        for (int i = 0; i < this->views.size(); i++)
+        {
+            for (auto adapter : this->views[i]->get_adapters())
+            {
+                adapter->set_view(i);
+            }
+        }
+
         for (auto adapter : DataAdapter::get_adapters())
         {
             adapter->initialize(socket);
         }
 
+        // precompute adapter list for every interned path, so updates are dispatched by single lookup
+        path_adapters_.clear();
+        path_adapters_.resize(SignalKPathIndex::count());
+        for (auto adapter : DataAdapter::get_adapters())
+        {
+            if (adapter->get_path_id() != SK_PATH_ID_NONE)
+            {
+                path_adapters_[adapter->get_path_id()].push_back(adapter);
+            }
+        }
+
+        // show last known values until websocket is connected
+        SignalKValueCache::restore();
+        for (int i = 0; i < path_adapters_.size(); i++)
+        {
+            SignalKValue_t cached;
+            if (!path_adapters_[i].empty() && SignalKValueCache::get(i, cached))
+            {
+                for (auto adapter : path_adapters_[i])
+                {
+                    adapter->on_cached(cached);
+                }
+            }
+        }
+
+        // watch face is shown after start, so all dynamic views are hidden
+        active_view_ = -1;
+        for (auto view : this->views)
+        {
+            view->on_hidden();
+        }
+
         ret = true;
     }
     else
@@ -78,29 +122,75 @@ bool DynamicGui::load_file(String path, lv_obj_t *parent, SignalKSocket *socket,
     return ret;
 }
 
-void DynamicGui::handle_signalk_update(const String &path, const JsonVariant &value)
+void DynamicGui::handle_signalk_update(sk_path_id_t path_id, const SignalKValue_t &value, const char *spill)
 {
-    for (auto adapter : DataAdapter::get_adapters())
+    if (path_id < path_adapters_.size())
     {
-        if (adapter->get_path() == path)
+        auto start = esp_timer_get_time();
+
+        for (auto adapter : path_adapters_[path_id])
         {
-            adapter->on_updated(value);
+            adapter->on_updated(value, spill);
         }
+
+        pipeline_stats_record(STAGE_RENDER, (uint32_t)(esp_timer_get_time() - start));
+
+        // it's written to SPIFFS at low power entry
+        SignalKValueCache::store(path_id, value);
     }
 }
 
-void DynamicGui::update_online(bool online)
+void DynamicGui::handle_power_event(PowerCode_t code)
 {
-    if (online_ != online)
+    if (code == PowerCode_t::POWER_ENTER_LOW_POWER)
     {
-        online_ = online;
+        SignalKValueCache::flush(SK_VALUE_CACHE_MIN_FLUSH_INTERVAL);
     }
-
-    if (!online)
+    else if (code == PowerCode_t::POWER_LEAVE_LOW_POWER)
     {
+        // deltas are dropped in low power, so shown values are stale until new ones arrive
         for (auto adapter : DataAdapter::get_adapters())
         {
             adapter->on_offline();
         }
     }
+}
+
+void DynamicGui::set_active_view(int index)
+{
+    if (index != active_view_)
+    {
+        if (active_view_ >= 0 && active_view_ < views.size())
+        {
+            views[active_view_]->on_hidden();
+        }
+
+        active_view_ = index;
+
+        if (active_view_ >= 0 && active_view_ < views.size())
+        {
+            views[active_view_]->on_visible();
+        }
+
+        if (socket_ != NULL)
+        {
+            socket_->set_active_view(active_view_);
+        }
+    }
+}
+
+void DynamicGui::update_online(bool online)
+{
+    if (online_ != online)
+    {
+        online_ = online;
+
+        if (!online)
+        {
+            for (auto adapter : DataAdapter::get_adapters())
+            {
+                adapter->on_offline();
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "component_factory.h"
 #include "vector"
 #include "networking/signalk_socket.h"
+#include "networking/signalk_path_index.h"
+#include "data_adapter.h"
+#include "hardware/hardware.h"
 
 
 class DynamicGui
@@ -11,12 +14,21 @@ public:
     DynamicGui();
     void initialize();
     bool load_file(String path, lv_obj_t*parent, SignalKSocket*socket, int& count);
-    void handle_signalk_update(const String& path, const JsonVariant&value);
+    /// Spill is raw JSON of value with type SK_VALUE_SPILLED (too large for SignalKValue_t), NULL otherwise
+    void handle_signalk_update(sk_path_id_t path_id, const SignalKValue_t&value, const char *spill = NULL);
+    /// Sets index of the view that is currently shown in tile view (-1 is watch face)
+    void set_active_view(int index);
+    int get_active_view() { return active_view_; }
     void update_online(bool online);
+    /// Flushes value cache when entering low power and marks values as stale after wake up
+    void handle_power_event(PowerCode_t code);
     lv_obj_t* get_tile_view() { return tile_view_; }
 private:
     ComponentFactory *factory;
     std::vector<DynamicView*> views;
+    std::vector<std::vector<DataAdapter*>> path_adapters_; // adapters bound to path, indexed by interned path ID
     lv_obj_t* tile_view_;
+    SignalKSocket* socket_ = NULL;
     bool online_ = false;
+    int active_view_ = -1;
 };
\ No newline at end of file
@@ -66,7 +66,8 @@ void DynamicLabel::load(const JsonObject &json)
             strcpy(formating.string_format, jsonFormating);
         }
         // register dataadapter that will connect SK receiver and this label
-        new DataAdapter(binding["path"].as<String>(), period, this);
+        auto adapter = new DataAdapter(binding["path"].as<String>(), period, this);
+        adapter->load_binding_options(binding);
 
         if (!textSet)
         {
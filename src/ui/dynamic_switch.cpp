@@ -55,6 +55,10 @@ void DynamicSwitch::load(const JsonObject &json)
 
         //register dataadapter that will connect SK receiver and this switch
         adapter_ = new DataAdapter(path_, period, this);
+        adapter_->load_binding_options(binding);
+
+        put_on_template_.compile(path_.c_str(), true);
+        put_off_template_.compile(path_.c_str(), false);
     }
 
     DynamicHelpers::set_location(ui_switch, json);
@@ -62,23 +66,31 @@ void DynamicSwitch::load(const JsonObject &json)
     DynamicHelpers::set_layout(ui_switch, parent_, json);
 }
 
+void DynamicSwitch::set_state(bool value)
+{
+    change_handler_locked_ = true;
+    if (value)
+    {
+        lv_switch_on(obj_, LV_ANIM_ON);
+    }
+    else
+    {
+        lv_switch_off(obj_, LV_ANIM_ON);
+    }
+    change_handler_locked_ = false;
+}
+
 void DynamicSwitch::update(const JsonVariant &json)
 {
-    auto value = false;
-    
     if (json.is<bool>())
     {
-        change_handler_locked_ = true;
-        auto value = json.as<bool>();
-        if (value)
-        {
-            lv_switch_on(obj_, LV_ANIM_ON);
-        }
-        else
+        confirmed_value_ = json.as<bool>();
+        // value from server may still be the old one while PUT is being processed, keep showing the new one
+        if (!put_pending_)
         {
-            lv_switch_off(obj_, LV_ANIM_ON);
+            put_request_id_[0] = '\0';
+            set_state(confirmed_value_);
         }
-        change_handler_locked_ = false;
     }
     else
     {
@@ -90,7 +102,17 @@ bool DynamicSwitch::send_put_request(bool value)
 {
     if(adapter_ != NULL)
     {
-        return adapter_->put_request(value);
+        // callback captures this switch, so only one PUT can be pending and it's cancelled with the switch
+        cancel_put_request();
+        put_pending_ = adapter_->put_request(value ? put_on_template_ : put_off_template_, [this, value](PutResult_t result, int status_code)
+                                             { handle_put_result(value, result, status_code); },
+                                             put_request_id_);
+        if (!put_pending_)
+        {
+            put_request_id_[0] = '\0';
+            set_state(confirmed_value_);
+        }
+        return put_pending_;
     }
     else
     {
@@ -98,13 +120,44 @@ bool DynamicSwitch::send_put_request(bool value)
     }
 }
 
+void DynamicSwitch::cancel_put_request()
+{
+    if (put_pending_ && adapter_ != NULL)
+    {
+        adapter_->cancel_put_request(put_request_id_);
+    }
+
+    put_pending_ = false;
+    put_request_id_[0] = '\0';
+}
+
+void DynamicSwitch::handle_put_result(bool value, PutResult_t result, int status_code)
+{
+    put_pending_ = false;
+    put_request_id_[0] = '\0';
+
+    if (result == PUT_COMPLETED)
+    {
+        confirmed_value_ = value;
+    }
+    else
+    {
+        ESP_LOGW("Switch", "PUT %s failed (result=%d, status=%d), rolling back.", path_.c_str(), (int)result, status_code);
+        set_state(confirmed_value_);
+        post_gui_warning(result == PUT_NOT_SENT ? LOC_SK_PUT_SEND_FAIL : LOC_SK_PUT_FAILED);
+    }
+}
+
 void DynamicSwitch::on_offline()
 {
+    confirmed_value_ = false;
     lv_switch_off(obj_, LV_ANIM_OFF);
 }
 
 void DynamicSwitch::destroy()
 {
+    cancel_put_request();
+
     if (obj_ != NULL)
     {
         lv_obj_del(obj_);
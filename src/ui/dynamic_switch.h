@@ -11,6 +11,7 @@ class DynamicSwitch : public Component
         {
 
         };
+        ~DynamicSwitch() { cancel_put_request(); }
         void load(const JsonObject &json) override;
         void update(const JsonVariant &update) override;
         void destroy() override;
@@ -19,7 +20,16 @@ class DynamicSwitch : public Component
         void on_offline() override;
     private:
         String path_;
+        SignalKPutTemplate put_on_template_;
+        SignalKPutTemplate put_off_template_;
         bool change_handler_locked_ = false;
+        bool confirmed_value_ = false; // last value received from server or confirmed by PUT response
+        bool put_pending_ = false;     // switch shows optimistic value until PUT request finishes
+        char put_request_id_[REQUEST_ID_STR_LEN] = ""; // pending PUT, its callback captures this switch
+        void set_state(bool value);
+        /// Pending PUT request is superseded by newer toggle or the switch is destroyed, its result is ignored
+        void cancel_put_request();
+        void handle_put_result(bool value, PutResult_t result, int status_code);
         DataAdapter* adapter_ = NULL;
 };
 
@@ -4,6 +4,7 @@
 #include "vector"
 #include "dynamic_helpers.h"
 #include "component.h"
+#include "data_adapter.h"
 
 enum ViewType_t
 {
@@ -15,6 +16,7 @@ class DynamicView
 {
 public:
     lv_obj_t *get_obj() { return container; }
+    std::vector<DataAdapter *> &get_adapters() { return adapters_; }
     void load(lv_obj_t *parent, JsonObject viewObject, ComponentFactory *factory)
     {
         //! main
@@ -55,6 +57,9 @@ public:
         }
 
         JsonArray components = viewObject["components"].as<JsonArray>();
+        // components register their data adapters while they are created, remember which of them belong to this view
+        auto &allAdapters = DataAdapter::get_adapters();
+        size_t firstAdapter = allAdapters.size();
 
         for (JsonObject component : components)
         {
@@ -70,6 +75,8 @@ public:
             }
         }
 
+        adapters_.assign(allAdapters.begin() + firstAdapter, allAdapters.end());
+
         if (viewObject.containsKey("layout"))
         {
             String layout = viewObject["layout"].as<String>();
@@ -82,17 +89,33 @@ public:
         }
     }
 
+    /// Called when view becomes active tile - components are updated with values received while the view was hidden
     void on_visible()
     {
+        for (auto adapter : adapters_)
+        {
+            adapter->set_visible(true);
+        }
+
         for (auto view : created_components)
         {
             lv_obj_realign(view->get_obj());
         }
     }
 
+    /// Called when view isn't active tile anymore - components will only store the latest value until view is visible again
+    void on_hidden()
+    {
+        for (auto adapter : adapters_)
+        {
+            adapter->set_visible(false);
+        }
+    }
+
 private:
     ViewType_t type;
     lv_obj_t *container;
     std::vector<Component *> created_components;
+    std::vector<DataAdapter *> adapters_;
     String name_;
 };
\ No newline at end of file
@@ -39,7 +39,7 @@
 #define LOC_SIGNALK_TOKEN_PENDING "Pending authorization"
 #define LOC_SIGNALK_TOKEN_RESET "Reset token"
 #define LOC_SIGNALK_REQUEST_REJECTED "Signal K server rejected authorization!"
-#define LOC_SIGNALK_CONNECTION_LOST "Signal K server connection lost! Please reconnect manually!"
+#define LOC_SIGNALK_CONNECTION_LOST "Signal K server connection lost! Reconnecting..."
 #define LOC_SIGNALK_ADDRESS_EMPTY "Set address"
 #define LOC_SIGNALK_INPUT_ADDRESS "Enter server address"
 #define LOC_SIGNALK_INPUT_PORT "Enter server port (default: 3000)"
@@ -72,6 +72,11 @@
 #define LOC_SCREEN_TIMEOUT "Screen\ntimeout: "
 #define LOC_INPUT_SCREEN_TIMEOUT "Scrn timeout (>=5 sec.)"
 #define LOC_WAKEUP_COUNT "Wake-up count: %d"
+#define LOC_SLEEP_WAKEUP_COUNT "Sleep CPU wake-ups: %u"
+#define LOC_SK_UPDATES_FMT "SK updates: %u (%u coalesced)"
+#define LOC_SK_RECONNECTS_FMT "SK reconnects: %u (last %u ms)"
+#define LOC_WIFI_TIME_TO_IP_FMT "Wi-Fi to IP: %u/%u/%u ms"
+#define LOC_WIFI_RADIO_ON_FMT "Wi-Fi radio: %u/%u ms/min"
 #define LOC_DISPLAY_BRIGHTNESS "Display\nbrightness: "
 #define LOC_DISPLAY_DOWNLOAD_UI "Download DynamicViews"
 #define LOC_DISPLAY_DOWNLOADING_UI "Downloading UI from SK server..."
@@ -104,3 +109,4 @@
 #define LOC_STARTUP_NETWORKING "Wifi & networking init..."
 #define LOC_SK_PUT_SEND_FAIL "Unable to send SK put request!"
 #define LOC_SK_PUT_SEND_FAIL "Unable to send Signal K put request!"
+#define LOC_SK_PUT_FAILED "Signal K put request failed!"
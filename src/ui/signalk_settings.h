@@ -220,14 +220,21 @@ private:
                         if (results != NULL)
                         {
                             mdns_result_t *r = results;
+                            bool first = true;
 
                             while (r)
                             {
                                 ESP_LOGI(SETTINGS_TAG, "mDNS search result %s:%d", r->hostname, r->port);
-                                server_address_ = String(r->hostname);
-                                server_port_ = r->port;
-                                signalk_changed_ = true;
-                                break;
+                                // first server is used, the others are kept for failover when connection is lost
+                                if (first)
+                                {
+                                    server_address_ = String(r->hostname);
+                                    server_port_ = r->port;
+                                    signalk_changed_ = true;
+                                    first = false;
+                                }
+                                sk_socket_->add_known_server(String(r->hostname), r->port);
+                                r = r->next;
                             }
                         }
                         else
@@ -69,6 +69,31 @@ protected:
         wakeup_count_ = lv_label_create(parent, NULL);
         lv_obj_align(wakeup_count_, uptime_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
         lv_label_set_text_fmt(wakeup_count_, LOC_WAKEUP_COUNT, gui_->get_wakeup_count());
+
+        sleep_wakeups_ = lv_label_create(parent, NULL);
+        lv_obj_align(sleep_wakeups_, wakeup_count_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+        lv_label_set_text_fmt(sleep_wakeups_, LOC_SLEEP_WAKEUP_COUNT, gui_->get_hardware()->get_sleep_wakeup_count());
+
+        sk_updates_ = lv_label_create(parent, NULL);
+        lv_obj_align(sk_updates_, sleep_wakeups_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+        lv_label_set_text_fmt(sk_updates_, LOC_SK_UPDATES_FMT, get_gui_sk_dv_delivered_count(), get_gui_sk_dv_coalesced_count());
+
+        auto &reconnect = gui_->get_sk_socket()->get_reconnect_scheduler();
+        sk_reconnects_ = lv_label_create(parent, NULL);
+        lv_obj_align(sk_reconnects_, sk_updates_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+        lv_label_set_text_fmt(sk_reconnects_, LOC_SK_RECONNECTS_FMT, reconnect.get_reconnect_count(), reconnect.get_last_reconnect_time());
+
+        // average time to IP of full / fast / fast with static IP connect
+        auto wifi = gui_->get_wifi_manager();
+        wifi_time_to_ip_ = lv_label_create(parent, NULL);
+        lv_obj_align(wifi_time_to_ip_, sk_reconnects_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+        lv_label_set_text_fmt(wifi_time_to_ip_, LOC_WIFI_TIME_TO_IP_FMT, wifi->get_average_time_to_ip(WIFI_PATH_FULL),
+                              wifi->get_average_time_to_ip(WIFI_PATH_FAST), wifi->get_average_time_to_ip(WIFI_PATH_FAST_IP));
+
+        // estimated radio on time of awake / low power modem sleep profile
+        wifi_radio_on_ = lv_label_create(parent, NULL);
+        lv_obj_align(wifi_radio_on_, wifi_time_to_ip_, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+        lv_label_set_text_fmt(wifi_radio_on_, LOC_WIFI_RADIO_ON_FMT, wifi->get_radio_on_estimate(false), wifi->get_radio_on_estimate(true));
     }
 
     virtual bool hide_internal() override
@@ -110,6 +135,11 @@ private:
     lv_obj_t* uptime_;
     UITicker* uptimeTicker_;
     lv_obj_t* wakeup_count_;
+    lv_obj_t* sleep_wakeups_;
+    lv_obj_t* sk_updates_;
+    lv_obj_t* sk_reconnects_;
+    lv_obj_t* wifi_time_to_ip_;
+    lv_obj_t* wifi_radio_on_;
     lv_obj_t* watchNameLabel_;
     lv_obj_t* watchNameButton_;
     lv_obj_t* watchName_;
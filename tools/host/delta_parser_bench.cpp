@@ -0,0 +1,177 @@
+/*
+ * Host benchmark of SignalKDeltaParser against ArduinoJson (deserializeJson into 4 kB document, walk of
+ * updates[].values[] and serializeJson of every value - what SignalKSocket::parse_data did before).
+ *
+ * Both parsers get the same mix of deltas (single values, several values in one update, position objects,
+ * notifications), the benchmark checks they found the same values and prints time per message of each.
+ *
+ *    ./delta_parser_bench --rounds 200
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ArduinoJson.h>
+#include "esp_timer.h"
+#include "networking/signalk_delta_parser.h"
+
+#define BENCH_MESSAGES 1000
+#define BENCH_VALUE_BUFFER 256
+
+static const char *SELF = "vessels.urn:mrn:signalk:uuid:c0d79334-4e25-4245-8892-54e8ccc8021d";
+
+static std::vector<std::string> generate_messages()
+{
+    std::vector<std::string> ret;
+    char buffer[1024];
+
+    for (int i = 0; i < BENCH_MESSAGES; i++)
+    {
+        switch (i % 4)
+        {
+        case 0:
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"%s\",\"updates\":[{\"source\":{\"label\":\"n2k\",\"type\":\"NMEA2000\",\"pgn\":130306,\"src\":\"105\"},"
+                     "\"timestamp\":\"2021-06-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"environment.wind.speedApparent\",\"value\":%d.%d}]}]}",
+                     SELF, i % 60, i % 20, i % 10);
+            break;
+        case 1:
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"%s\",\"updates\":[{\"source\":{\"label\":\"n2k\",\"type\":\"NMEA2000\",\"pgn\":129026,\"src\":\"3\"},"
+                     "\"timestamp\":\"2021-06-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"navigation.courseOverGroundTrue\",\"value\":1.%d},"
+                     "{\"path\":\"navigation.speedOverGround\",\"value\":3.%d}]},{\"source\":{\"label\":\"n2k\",\"src\":\"3\"},"
+                     "\"timestamp\":\"2021-06-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"navigation.headingTrue\",\"value\":1.0%d}]}]}",
+                     SELF, i % 60, i % 10, i % 10, i % 60, i % 10);
+            break;
+        case 2:
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"%s\",\"updates\":[{\"source\":{\"label\":\"gps\",\"type\":\"NMEA0183\",\"talker\":\"GP\",\"sentence\":\"RMC\"},"
+                     "\"timestamp\":\"2021-06-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"navigation.position\",\"value\":"
+                     "{\"longitude\":24.95%03d,\"latitude\":60.16%03d}}]}]}",
+                     SELF, i % 60, i, i);
+            break;
+        default:
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"%s\",\"updates\":[{\"source\":{\"label\":\"derived-data\"},\"timestamp\":\"2021-06-01T10:00:%02d.000Z\","
+                     "\"values\":[{\"path\":\"notifications.environment.depth.belowKeel\",\"value\":{\"state\":\"%s\","
+                     "\"method\":[\"visual\",\"sound\"],\"message\":\"Depth below keel is \\\"%d.%d\\\" m\"}},"
+                     "{\"path\":\"environment.depth.belowKeel\",\"value\":%d.%d}]}]}",
+                     SELF, i % 60, i % 8 == 3 ? "alarm" : "normal", i % 5, i % 10, i % 5, i % 10);
+            break;
+        }
+
+        ret.push_back(buffer);
+    }
+
+    return ret;
+}
+
+static volatile int sink = 0;
+
+static int parse_streaming(const std::string &message)
+{
+    SignalKDeltaParser parser(message.data(), message.size());
+    int count = 0;
+
+    if (!parser.parse([&count](const SignalKDeltaValue_t &value)
+                      {
+                          sink += value.path_len + value.value_len;
+                          count++;
+                      }))
+    {
+        return -1;
+    }
+
+    return count;
+}
+
+static int parse_arduinojson(const std::string &message, DynamicJsonDocument &doc)
+{
+    char value_buffer[BENCH_VALUE_BUFFER];
+    int count = 0;
+
+    if (deserializeJson(doc, message.data(), message.size()) != DeserializationError::Ok)
+    {
+        return -1;
+    }
+
+    for (JsonObject update : doc["updates"].as<JsonArray>())
+    {
+        for (JsonObject value : update["values"].as<JsonArray>())
+        {
+            const char *path = value["path"];
+            size_t length = serializeJson(value["value"], value_buffer, sizeof(value_buffer));
+            sink += strlen(path) + length;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = 200;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--rounds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    auto messages = generate_messages();
+    DynamicJsonDocument doc(4096);
+    size_t bytes = 0;
+
+    // both parsers must find the same values, otherwise the comparison makes no sense
+    for (auto &message : messages)
+    {
+        int streaming = parse_streaming(message);
+        int arduinojson = parse_arduinojson(message, doc);
+        if (streaming <= 0 || streaming != arduinojson)
+        {
+            fprintf(stderr, "Parsers disagree (streaming=%d, ArduinoJson=%d) on: %s\n", streaming, arduinojson, message.c_str());
+            return 1;
+        }
+        bytes += message.size();
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto &message : messages)
+        {
+            parse_streaming(message);
+        }
+    }
+    int64_t streaming_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto &message : messages)
+        {
+            parse_arduinojson(message, doc);
+        }
+    }
+    int64_t arduinojson_us = esp_timer_get_time() - start;
+
+    double total = (double)rounds * messages.size();
+    printf("%d messages x %d rounds, average message %u bytes\n", (int)messages.size(), rounds, (unsigned)(bytes / messages.size()));
+    printf("SignalKDeltaParser: %.3f us/msg\n", streaming_us / total);
+    printf("ArduinoJson:        %.3f us/msg\n", arduinojson_us / total);
+    if (streaming_us > 0)
+    {
+        printf("speedup:            %.1fx\n", (double)arduinojson_us / streaming_us);
+    }
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Host test of WebsocketFrameAssembler. Messages are replayed the way esp_websocket_client delivers them:
+ * split into continuation frames (like stand-in server with --fragment N) and every frame split into chunks
+ * of client rx buffer size, with and without FIN bit reported by the client.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "networking/ws_frame_assembler.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(condition))                                                         \
+        {                                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                           \
+        }                                                                         \
+    } while (0)
+
+struct Replay_t
+{
+    int fragment = 0;   // payload bytes of one frame, 0 = whole message in one frame
+    int chunk = 1024;   // client rx buffer size
+    bool fin = false;   // client reports FIN bit
+    bool ping = false;  // server ping between frames of the message
+};
+
+/// Feeds one message to the assembler, returns delivered messages
+static std::vector<std::string> replay(WebsocketFrameAssembler &assembler, const std::string &message, const Replay_t &options)
+{
+    std::vector<std::string> ret;
+    int fragment = options.fragment > 0 ? options.fragment : (int)message.size();
+
+    for (size_t offset = 0; offset < message.size(); offset += fragment)
+    {
+        std::string frame = message.substr(offset, fragment);
+        bool last = offset + fragment >= message.size();
+        int op_code = offset == 0 ? WS_OPCODE_TEXT : WS_OPCODE_CONTINUATION;
+
+        if (options.ping && offset > 0)
+        {
+            CHECK(!assembler.append(0x9, "ping", 4, 4, 0, options.fin ? 1 : WS_FIN_UNKNOWN));
+        }
+
+        for (size_t chunk = 0; chunk < frame.size(); chunk += options.chunk)
+        {
+            std::string data = frame.substr(chunk, options.chunk);
+            if (assembler.append(op_code, data.data(), data.size(), frame.size(), chunk, options.fin ? (last ? 1 : 0) : WS_FIN_UNKNOWN))
+            {
+                ret.push_back(std::string(assembler.get_data(), assembler.get_length()));
+            }
+        }
+    }
+
+    return ret;
+}
+
+static std::string make_delta(int i)
+{
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+             "{\"context\":\"vessels.self\",\"updates\":[{\"source\":{\"label\":\"n2k\"},\"values\":["
+             "{\"path\":\"navigation.position\",\"value\":{\"longitude\":24.9%d,\"latitude\":60.1,\"altitude\":0}},"
+             "{\"path\":\"notifications.test\",\"value\":{\"state\":\"alarm\",\"message\":\"brace } [ and \\\"quote\\\" %d\"}},"
+             "{\"path\":\"environment.depth.belowKeel\",\"value\":%d.5}]}]}",
+             i, i, i);
+    return buffer;
+}
+
+static void test_single_chunk_is_not_copied()
+{
+    WebsocketFrameAssembler assembler;
+    std::string message = make_delta(1);
+
+    CHECK(assembler.append(WS_OPCODE_TEXT, message.data(), message.size(), message.size(), 0));
+    CHECK(assembler.get_data() == message.data());
+    CHECK(assembler.get_length() == (int)message.size());
+    CHECK(assembler.get_reassembled_count() == 0);
+}
+
+static void test_fragmented_messages()
+{
+    int replays = 0;
+
+    for (int fin = 0; fin < 2; fin++)
+    {
+        for (int fragment = 0; fragment <= 120; fragment += (fragment < 40 ? 1 : 13))
+        {
+            for (int chunk : {5, 16, 1024})
+            {
+                WebsocketFrameAssembler assembler;
+                Replay_t options;
+                options.fragment = fragment;
+                options.chunk = chunk;
+                options.fin = fin == 1;
+                options.ping = fragment % 2 == 1;
+
+                // several messages in a row, every fragment boundary (also right after inner "}") is tried
+                for (int i = 0; i < 3; i++)
+                {
+                    std::string message = make_delta(i);
+                    auto delivered = replay(assembler, message, options);
+                    CHECK(delivered.size() == 1);
+                    CHECK(delivered.size() == 1 && delivered[0] == message);
+                    replays++;
+                }
+
+                CHECK(assembler.get_dropped_incomplete_count() == 0);
+                CHECK(assembler.get_dropped_oversize_count() == 0);
+            }
+        }
+    }
+
+    printf("fragmented messages: %d replays\n", replays);
+}
+
+static void test_oversize_message_is_skipped()
+{
+    WebsocketFrameAssembler assembler(128);
+    Replay_t options;
+    options.fragment = 40;
+    options.chunk = 16;
+
+    auto delivered = replay(assembler, make_delta(1), options);
+    CHECK(delivered.empty());
+    CHECK(assembler.get_dropped_oversize_count() == 1);
+
+    // next message is received again
+    std::string small = "{\"context\":\"vessels.self\",\"updates\":[]}";
+    delivered = replay(assembler, small, options);
+    CHECK(delivered.size() == 1 && delivered[0] == small);
+}
+
+static void test_missing_continuation_is_dropped()
+{
+    WebsocketFrameAssembler assembler;
+    std::string message = make_delta(1);
+
+    // first frame only, last continuation frame never comes
+    std::string first = message.substr(0, 50);
+    CHECK(!assembler.append(WS_OPCODE_TEXT, first.data(), first.size(), first.size(), 0));
+
+    std::string next = make_delta(2);
+    CHECK(assembler.append(WS_OPCODE_TEXT, next.data(), next.size(), next.size(), 0));
+    CHECK(std::string(assembler.get_data(), assembler.get_length()) == next);
+    CHECK(assembler.get_dropped_incomplete_count() == 1);
+}
+
+static void test_orphan_continuation_is_dropped()
+{
+    WebsocketFrameAssembler assembler;
+    std::string tail = "\"value\":1}]}]}";
+
+    CHECK(!assembler.append(WS_OPCODE_CONTINUATION, tail.data(), tail.size(), tail.size(), 0));
+    CHECK(assembler.get_dropped_incomplete_count() == 1);
+
+    std::string next = make_delta(3);
+    Replay_t options;
+    options.fragment = 30;
+    auto delivered = replay(assembler, next, options);
+    CHECK(delivered.size() == 1 && delivered[0] == next);
+}
+
+int main()
+{
+    test_single_chunk_is_not_copied();
+    test_fragmented_messages();
+    test_oversize_message_is_skipped();
+    test_missing_continuation_is_dropped();
+    test_orphan_continuation_is_dropped();
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("frame assembler: all checks passed\n");
+    return 0;
+}
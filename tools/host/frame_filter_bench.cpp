@@ -0,0 +1,212 @@
+/*
+ * Host benchmark of SignalKFrameFilter on AIS-heavy stream (like busy harbour with tools/signalk_standin --ais):
+ *  - parse all: every message is parsed by SignalKDeltaParser and its paths are looked up in SignalKPathIndex
+ *    (what SignalKSocket::parse_data did before the prefilter)
+ *  - prefilter: messages are classified first, deltas of other vessels and deltas without bound path are rejected
+ * Both modes have to deliver the same number of bound values. Classification of typical messages is checked as well,
+ * so the benchmark fails when the filter rejects something it shouldn't.
+ *
+ *    ./frame_filter_bench --messages 10000 --rounds 20 --ais 80
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "esp_timer.h"
+#include "networking/signalk_frame_filter.h"
+#include "networking/signalk_delta_parser.h"
+#include "networking/signalk_path_index.h"
+
+#define SELF_CONTEXT "vessels.urn:mrn:signalk:uuid:c0d79334-4e25-4245-8892-54e8ccc8021d"
+
+static const char *HELLO = "{\"name\":\"signalk-server\",\"version\":\"1.46.3\",\"self\":\"" SELF_CONTEXT "\",\"roles\":[\"master\",\"main\"],"
+                           "\"timestamp\":\"2024-05-01T10:00:00.000Z\"}";
+
+static int failures = 0;
+
+static void check_type(SignalKFrameFilter &filter, const std::string &message, bool low_power, SignalKFrameType_t expected)
+{
+    auto type = filter.classify(message.data(), message.size(), low_power);
+    if (type != expected)
+    {
+        fprintf(stderr, "Message classified as %d instead of %d (low_power=%d): %s\n", (int)type, (int)expected, (int)low_power,
+                message.c_str());
+        failures++;
+    }
+}
+
+static std::vector<std::string> make_messages(int count, int ais_percent)
+{
+    std::vector<std::string> ret;
+    char buffer[768];
+
+    for (int i = 0; i < count; i++)
+    {
+        if (i % 100 < ais_percent)
+        {
+            // AIS target - position, course, speed, heading and static data in one delta
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"vessels.urn:mrn:imo:mmsi:230%06d\",\"updates\":[{\"source\":{\"label\":\"ais\",\"type\":\"NMEA0183\","
+                     "\"talker\":\"AI\",\"sentence\":\"VDM\"},\"$source\":\"ais.AI\",\"timestamp\":\"2024-05-01T10:00:%02d.000Z\",\"values\":["
+                     "{\"path\":\"navigation.position\",\"value\":{\"longitude\":24.9%04d,\"latitude\":60.1%04d}},"
+                     "{\"path\":\"navigation.courseOverGroundTrue\",\"value\":1.%d},{\"path\":\"navigation.speedOverGround\",\"value\":4.%d},"
+                     "{\"path\":\"navigation.headingTrue\",\"value\":1.%d},{\"path\":\"\",\"value\":{\"mmsi\":\"230%06d\",\"name\":\"TARGET %d\"}}]}]}",
+                     i % 500, i % 60, i % 10000, (i * 7) % 10000, i % 10, i % 10, i % 10, i % 500, i % 500);
+        }
+        else if (i % 2 == 0)
+        {
+            // own vessel, bound paths
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"" SELF_CONTEXT "\",\"updates\":[{\"source\":{\"label\":\"n2k\",\"type\":\"NMEA2000\",\"pgn\":130306,\"src\":\"105\"},"
+                     "\"timestamp\":\"2024-05-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"environment.wind.speedApparent\",\"value\":%d.5},"
+                     "{\"path\":\"navigation.speedOverGround\",\"value\":3.%d}]}]}",
+                     i % 60, i % 20, i % 10);
+        }
+        else
+        {
+            // own vessel, nothing on the watch shows it
+            snprintf(buffer, sizeof(buffer),
+                     "{\"context\":\"" SELF_CONTEXT "\",\"updates\":[{\"source\":{\"label\":\"n2k\",\"type\":\"NMEA2000\",\"pgn\":127508,\"src\":\"12\"},"
+                     "\"timestamp\":\"2024-05-01T10:00:%02d.000Z\",\"values\":[{\"path\":\"electrical.batteries.1.voltage\",\"value\":12.%d},"
+                     "{\"path\":\"electrical.batteries.1.current\",\"value\":-3.%d}]}]}",
+                     i % 60, i % 10, i % 10);
+        }
+        ret.push_back(buffer);
+    }
+
+    return ret;
+}
+
+static void check_classification(const std::vector<std::string> &messages, int ais_percent)
+{
+    SignalKFrameFilter filter;
+    check_type(filter, HELLO, false, SK_FRAME_HELLO);
+
+    if (ais_percent > 0)
+    {
+        check_type(filter, messages[0], false, SK_FRAME_DELTA_OTHER_CONTEXT);
+    }
+
+    for (auto &message : messages)
+    {
+        if (message.find(SELF_CONTEXT) != std::string::npos)
+        {
+            bool bound = message.find("environment.wind.speedApparent") != std::string::npos;
+            check_type(filter, message, false, bound ? SK_FRAME_DELTA : SK_FRAME_DELTA_UNBOUND);
+            // only notifications are wanted in low power mode
+            check_type(filter, message, true, SK_FRAME_DELTA_UNBOUND);
+            break;
+        }
+    }
+
+    check_type(filter, "{\"requestId\":\"4f2a\",\"state\":\"COMPLETED\",\"statusCode\":200}", false, SK_FRAME_REQUEST);
+    check_type(filter, "{\"context\":\"vessels.self\",\"updates\":[{\"values\":[{\"path\":\"notifications.mob\",\"value\":{\"state\":\"emergency\"}}]}]}",
+               true, SK_FRAME_DELTA);
+}
+
+int main(int argc, char **argv)
+{
+    int message_count = 10000;
+    int rounds = 20;
+    int ais_percent = 80;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--messages") == 0 && i + 1 < argc)
+        {
+            message_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--ais") == 0 && i + 1 < argc)
+        {
+            ais_percent = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--messages N] [--rounds N] [--ais PERCENT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (message_count <= 0 || rounds <= 0 || ais_percent < 0 || ais_percent > 100)
+    {
+        fprintf(stderr, "Messages and rounds must be at least 1, AIS share 0 - 100 %%\n");
+        return 2;
+    }
+
+    // paths bound to watch components
+    SignalKPathIndex::intern("environment.wind.speedApparent");
+    SignalKPathIndex::intern("navigation.courseOverGroundTrue");
+    SignalKPathIndex::intern("notifications.mob");
+
+    auto messages = make_messages(message_count, ais_percent);
+    check_classification(messages, ais_percent);
+
+    // parser doesn't look at context, only own vessel values are counted (parse all dispatched AIS values as own)
+    std::vector<bool> own(messages.size());
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+        own[i] = messages[i].find(SELF_CONTEXT) != std::string::npos;
+    }
+
+    uint32_t bound_values[2] = {0, 0};
+    int64_t elapsed_us[2] = {0, 0};
+    SignalKFrameFilter filter;
+    filter.classify(HELLO, strlen(HELLO), false);
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        int64_t start = esp_timer_get_time();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (size_t i = 0; i < messages.size(); i++)
+            {
+                auto &message = messages[i];
+                bool is_own = own[i];
+                if (mode == 1 && SignalKFrameFilter::is_rejected(filter.classify(message.data(), message.size(), false)))
+                {
+                    continue;
+                }
+
+                SignalKDeltaParser parser(message.data(), message.size());
+                parser.parse([&bound_values, mode, is_own](const SignalKDeltaValue_t &value)
+                             {
+                                 if (is_own && SignalKPathIndex::find(value.path, value.path_len) != SK_PATH_ID_NONE)
+                                 {
+                                     bound_values[mode]++;
+                                 }
+                             });
+            }
+        }
+        elapsed_us[mode] = esp_timer_get_time() - start;
+    }
+
+    double total = (double)rounds * messages.size();
+    printf("%d messages (%d %% AIS) x %d rounds\n", (int)messages.size(), ais_percent, rounds);
+    printf("parse all: %.3f us/message\n", elapsed_us[0] / total);
+    printf("prefilter: %.3f us/message (passed=%u, other context=%u, unbound=%u)\n", elapsed_us[1] / total, filter.get_passed_count(),
+           filter.get_other_context_count(), filter.get_unbound_count());
+    if (elapsed_us[1] > 0)
+    {
+        printf("speedup:   %.1fx\n", (double)elapsed_us[0] / elapsed_us[1]);
+    }
+
+    // own vessel values have to get through the same in both modes
+    if (bound_values[0] != bound_values[1])
+    {
+        fprintf(stderr, "Prefilter lost values (parse all=%u, prefilter=%u)\n", bound_values[0], bound_values[1]);
+        failures++;
+    }
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
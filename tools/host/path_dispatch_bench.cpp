@@ -0,0 +1,152 @@
+/*
+ * Host benchmark of dispatching SignalK values to bound components:
+ *  - string dispatch: value path is copied into String and compared with path of every adapter
+ *    (what DynamicGui::handle_signalk_update did before path IDs)
+ *  - flat dispatch: single SignalKPathIndex::find of the raw path slice and fan out to adapters of that path ID
+ *    (DynamicGui::path_adapters_)
+ * Adapters are plain stand-ins of DataAdapter (path + counter), so only dispatch cost is measured.
+ *
+ *    ./path_dispatch_bench --adapters 60 --paths 40 --rounds 2000
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "networking/signalk_path_index.h"
+
+struct BenchAdapter_t
+{
+    String path;
+    sk_path_id_t path_id;
+    uint32_t updates;
+};
+
+int main(int argc, char **argv)
+{
+    int adapter_count = 60;
+    int path_count = 40;
+    int rounds = 2000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--adapters") == 0 && i + 1 < argc)
+        {
+            adapter_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--paths") == 0 && i + 1 < argc)
+        {
+            path_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--adapters N] [--paths N] [--rounds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (path_count <= 0 || path_count > SK_PATH_INDEX_MAX || adapter_count <= 0)
+    {
+        fprintf(stderr, "Paths must be 1 - %d, adapters at least 1\n", SK_PATH_INDEX_MAX);
+        return 2;
+    }
+
+    // bound paths share long prefixes like real ones, so string compare can't bail out at first character
+    std::vector<std::string> paths;
+    char path[96];
+    for (int i = 0; i < path_count; i++)
+    {
+        snprintf(path, sizeof(path), "environment.outside.sensor%d.temperature", i);
+        paths.push_back(path);
+    }
+
+    // adapters are bound round-robin, so some paths have more components (label + gauge of the same value)
+    std::vector<BenchAdapter_t> adapters(adapter_count);
+    std::vector<std::vector<BenchAdapter_t *>> path_adapters(SK_PATH_INDEX_MAX);
+    for (int i = 0; i < adapter_count; i++)
+    {
+        auto &adapter = adapters[i];
+        auto &bound = paths[i % path_count];
+        adapter.path = bound;
+        adapter.path_id = SignalKPathIndex::intern(bound.c_str(), bound.size());
+        adapter.updates = 0;
+        path_adapters[adapter.path_id].push_back(&adapter);
+    }
+
+    // every round delivers one value of every bound path and the same number of values nobody is bound to
+    std::vector<std::string> values = paths;
+    for (int i = 0; i < path_count; i++)
+    {
+        snprintf(path, sizeof(path), "environment.outside.sensor%d.humidity", i);
+        values.push_back(path);
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto &value : values)
+        {
+            String value_path(value.c_str());
+            for (auto &adapter : adapters)
+            {
+                if (adapter.path == value_path)
+                {
+                    adapter.updates++;
+                }
+            }
+        }
+    }
+    int64_t string_us = esp_timer_get_time() - start;
+
+    uint32_t string_updates = 0;
+    for (auto &adapter : adapters)
+    {
+        string_updates += adapter.updates;
+        adapter.updates = 0;
+    }
+
+    start = esp_timer_get_time();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto &value : values)
+        {
+            sk_path_id_t id = SignalKPathIndex::find(value.data(), value.size());
+            if (id != SK_PATH_ID_NONE)
+            {
+                for (auto adapter : path_adapters[id])
+                {
+                    adapter->updates++;
+                }
+            }
+        }
+    }
+    int64_t flat_us = esp_timer_get_time() - start;
+
+    uint32_t flat_updates = 0;
+    for (auto &adapter : adapters)
+    {
+        flat_updates += adapter.updates;
+    }
+
+    if (string_updates != flat_updates || flat_updates != (uint32_t)(adapter_count * rounds))
+    {
+        fprintf(stderr, "Dispatch results differ (string=%u, flat=%u)\n", string_updates, flat_updates);
+        return 1;
+    }
+
+    double total = (double)rounds * values.size();
+    printf("%d adapters, %d bound paths, %d values x %d rounds\n", adapter_count, path_count, (int)values.size(), rounds);
+    printf("string dispatch: %.3f us/value\n", string_us / total);
+    printf("flat dispatch:   %.3f us/value\n", flat_us / total);
+    if (flat_us > 0)
+    {
+        printf("speedup:         %.1fx\n", (double)string_us / flat_us);
+    }
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "esp_timer.h"
+
+/// Host shim of Arduino String, only the part used by the core (copying, comparison, c_str)
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char *text) : std::string(text != nullptr ? text : "") {}
+    String(const std::string &text) : std::string(text) {}
+    bool isEmpty() const { return empty(); }
+};
+
+inline uint32_t millis()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+inline void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/// Host shim of heap capabilities - there is a single heap, so its statistics aren't available
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+// size_t is 32 bit on ESP32, so the core prints it with %u
+inline unsigned int heap_caps_get_minimum_free_size(uint32_t)
+{
+    return 0;
+}
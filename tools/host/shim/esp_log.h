@@ -0,0 +1,32 @@
+#pragma once
+#include <stdio.h>
+
+/*
+ * Host shim of ESP-IDF logging. Like on the watch, LOG_LOCAL_LEVEL (set before the include or by the build) selects
+ * compiled-in messages, default is warnings and errors only so benchmarks aren't slowed down by logging.
+ */
+#define ESP_LOG_NONE 0
+#define ESP_LOG_ERROR 1
+#define ESP_LOG_WARN 2
+#define ESP_LOG_INFO 3
+#define ESP_LOG_DEBUG 4
+#define ESP_LOG_VERBOSE 5
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_WARN
+#endif
+
+#define ESP_HOST_LOG(level, letter, tag, format, ...)                            \
+    do                                                                           \
+    {                                                                            \
+        if (LOG_LOCAL_LEVEL >= level)                                            \
+        {                                                                        \
+            fprintf(stderr, letter " (%s): " format "\n", tag, ##__VA_ARGS__);   \
+        }                                                                        \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_HOST_LOG(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_HOST_LOG(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_HOST_LOG(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_HOST_LOG(ESP_LOG_DEBUG, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_HOST_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+#include <random>
+
+/// Host shim of hardware RNG
+inline uint32_t esp_random()
+{
+    static std::random_device device;
+    return device();
+}
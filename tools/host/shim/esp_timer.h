@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+/// Host shim of esp_timer_get_time - microseconds of monotonic clock
+inline int64_t esp_timer_get_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
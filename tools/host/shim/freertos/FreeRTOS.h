@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+/// Host shim of FreeRTOS types and of ESP32 critical sections (spinlock)
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+
+struct portMUX_TYPE
+{
+    std::atomic_flag flag;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {ATOMIC_FLAG_INIT}
+
+inline void portENTER_CRITICAL(portMUX_TYPE *mux)
+{
+    while (mux->flag.test_and_set(std::memory_order_acquire))
+    {
+    }
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE *mux)
+{
+    mux->flag.clear(std::memory_order_release);
+}
@@ -0,0 +1,451 @@
+/*
+ * Subscription traffic test against SignalK stand-in server (tools/signalk_standin.cpp), which handles subscriptions
+ * like signalk-server: only unsubscribe of all paths is honoured and repeated subscriptions aren't merged.
+ * Test connects as the watch does (stream with subscribe=none), builds subscription messages by SignalKSubscriptionPlan
+ * and goes through several wake / view change / sleep cycles. For every phase it counts bytes sent and received and
+ * values of every path, and checks that:
+ *  - only low power paths are received in low power
+ *  - no path is received more often than its period allows (duplicate subscriptions on the server)
+ *  - received bytes of the same phase don't grow from cycle to cycle
+ *  - resync (after lost subscription message) unsubscribes everything and subscribes the whole desired set
+ *
+ *    ./subscription_traffic_test ./signalk_standin [--cycles N] [--phase MS]
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "esp_timer.h"
+#include "networking/signalk_subscription_plan.h"
+
+#define VIEW_PERIOD 500
+#define LOW_POWER_PERIOD 1000
+#define BACKGROUND_PERIOD 2000
+#define SETTLE_MS 300 // values of previous phase can still be on the way
+
+static int failures = 0;
+
+struct PhaseStats_t
+{
+    uint32_t tx_bytes = 0;
+    uint32_t rx_bytes = 0;
+    std::map<std::string, int> values;
+};
+
+static bool send_all(int fd, const std::string &data)
+{
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        offset += sent;
+    }
+    return true;
+}
+
+/// Sends masked text frame (client frames must be masked), returns bytes on the wire
+static uint32_t send_text(int fd, const std::string &text)
+{
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::string frame;
+    frame += (char)0x81;
+    if (text.size() < 126)
+    {
+        frame += (char)(0x80 | text.size());
+    }
+    else
+    {
+        frame += (char)(0x80 | 126);
+        frame += (char)(text.size() >> 8);
+        frame += (char)(text.size() & 0xFF);
+    }
+    frame.append((const char *)mask, 4);
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        frame += (char)(text[i] ^ mask[i % 4]);
+    }
+
+    return send_all(fd, frame) ? frame.size() : 0;
+}
+
+class StreamReader
+{
+public:
+    explicit StreamReader(int fd) : fd_(fd) {}
+
+    /// Receives frames for given time, values of every path received after settle_ms are counted
+    bool receive(int duration_ms, int settle_ms, PhaseStats_t &stats)
+    {
+        int64_t start = esp_timer_get_time();
+        int64_t end = start + duration_ms * 1000LL;
+
+        while (true)
+        {
+            int64_t now = esp_timer_get_time();
+            if (now >= end)
+            {
+                return true;
+            }
+
+            pollfd fds = {fd_, POLLIN, 0};
+            if (poll(&fds, 1, (int)((end - now) / 1000) + 1) <= 0)
+            {
+                continue;
+            }
+
+            char buffer[4096];
+            ssize_t received = recv(fd_, buffer, sizeof(buffer), 0);
+            if (received <= 0)
+            {
+                return false;
+            }
+            stats.rx_bytes += received;
+            data_.append(buffer, received);
+
+            std::string message;
+            while (next_message(message))
+            {
+                if (esp_timer_get_time() - start >= settle_ms * 1000LL)
+                {
+                    count_values(message, stats);
+                }
+            }
+        }
+    }
+
+private:
+    int fd_;
+    std::string data_;
+
+    bool next_message(std::string &message)
+    {
+        if (data_.size() < 2)
+        {
+            return false;
+        }
+
+        size_t header = 2;
+        size_t length = (uint8_t)data_[1] & 0x7F;
+        if (length == 126)
+        {
+            if (data_.size() < 4)
+            {
+                return false;
+            }
+            length = ((uint8_t)data_[2] << 8) | (uint8_t)data_[3];
+            header = 4;
+        }
+        else if (length == 127)
+        {
+            if (data_.size() < 10)
+            {
+                return false;
+            }
+            length = 0;
+            for (int i = 2; i < 10; i++)
+            {
+                length = (length << 8) | (uint8_t)data_[i];
+            }
+            header = 10;
+        }
+
+        if (data_.size() < header + length)
+        {
+            return false;
+        }
+
+        // stand-in sends every message in single frame (without --fragment)
+        message = data_.substr(header, length);
+        data_.erase(0, header + length);
+        return true;
+    }
+
+    static void count_values(const std::string &message, PhaseStats_t &stats)
+    {
+        const std::string key = "\"path\":\"";
+        size_t position = 0;
+
+        while ((position = message.find(key, position)) != std::string::npos)
+        {
+            position += key.size();
+            size_t end = message.find('"', position);
+            if (end == std::string::npos)
+            {
+                break;
+            }
+            stats.values[message.substr(position, end - position)]++;
+            position = end;
+        }
+    }
+};
+
+static pid_t start_standin(const char *standin, int port)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // stand-in logs every subscription, test output shows only its own summary
+        freopen("/dev/null", "w", stdout);
+        char port_text[16];
+        snprintf(port_text, sizeof(port_text), "%d", port);
+        execl(standin, standin, "--port", port_text, "--paths", "11", (char *)NULL);
+        _exit(127);
+    }
+
+    return pid;
+}
+
+static int connect_stream(int port)
+{
+    for (int attempt = 0; attempt < 50; attempt++)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (connect(fd, (sockaddr *)&address, sizeof(address)) == 0)
+        {
+            std::string request = "GET /signalk/v1/stream?subscribe=none HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                                  "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            std::string response;
+            char c;
+            send_all(fd, request);
+            while (response.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1)
+            {
+                response += c;
+            }
+
+            if (response.compare(0, 12, "HTTP/1.1 101") == 0)
+            {
+                return fd;
+            }
+        }
+
+        close(fd);
+        usleep(100000);
+    }
+
+    return -1;
+}
+
+/// Sends changes the way SignalKSocket::send_subscription_changes does
+static uint32_t send_changes(int fd, std::map<String, SignalKSubscription *> &subscriptions, bool is_lp, int view)
+{
+    SignalKSubscriptionPlan plan;
+    uint32_t ret = 0;
+
+    if (plan.build(subscriptions, is_lp, view, BACKGROUND_PERIOD))
+    {
+        if (plan.get_unsubscribe_all())
+        {
+            ret += send_text(fd, SK_UNSUBSCRIBE_ALL);
+        }
+
+        if (plan.get_subscribe_message().length() > 0)
+        {
+            ret += send_text(fd, plan.get_subscribe_message());
+        }
+    }
+
+    return ret;
+}
+
+static void check_phase(const char *name, int cycle, const PhaseStats_t &stats, std::map<String, SignalKSubscription *> &subscriptions,
+                        bool is_lp, int view, int phase_ms)
+{
+    int measured_ms = phase_ms - SETTLE_MS;
+
+    for (auto &value : stats.values)
+    {
+        auto subscription = subscriptions.find(value.first);
+        uint period = subscription == subscriptions.end() ? 0 : SignalKSubscriptionPlan::get_desired_period(subscription->second, is_lp, view, BACKGROUND_PERIOD);
+
+        if (period == 0)
+        {
+            fprintf(stderr, "cycle %d %s: %d values of unsubscribed path %s\n", cycle, name, value.second, value.first.c_str());
+            failures++;
+        }
+        else if (value.second > measured_ms / (int)period + 2)
+        {
+            fprintf(stderr, "cycle %d %s: %d values of %s with period %u ms (duplicate subscription?)\n", cycle, name, value.second,
+                    value.first.c_str(), period);
+            failures++;
+        }
+    }
+}
+
+/// Subscription message was lost, so active periods are wrong - resync has to restore the whole desired set
+static void check_resync(int fd, StreamReader &reader, std::map<String, SignalKSubscription *> &subscriptions, int phase_ms)
+{
+    int desired = 0;
+    for (auto &subscription : subscriptions)
+    {
+        // active periods were set as if subscribe message of view 0 was sent
+        uint period = SignalKSubscriptionPlan::get_desired_period(subscription.second, false, 0, BACKGROUND_PERIOD);
+        desired += period > 0 ? 1 : 0;
+        subscription.second->set_active_period(period);
+    }
+
+    SignalKSubscriptionPlan plan;
+    if (!plan.build(subscriptions, false, 0, BACKGROUND_PERIOD, true) || !plan.get_unsubscribe_all() || plan.get_subscribed_count() != desired)
+    {
+        fprintf(stderr, "resync: unsubscribe all=%d, subscribed %d of %d paths\n", (int)plan.get_unsubscribe_all(),
+                plan.get_subscribed_count(), desired);
+        failures++;
+        return;
+    }
+
+    PhaseStats_t stats;
+    send_text(fd, SK_UNSUBSCRIBE_ALL);
+    send_text(fd, plan.get_subscribe_message());
+    // new subscription gets cached value right away, so even slow paths are received at least once
+    reader.receive(phase_ms, 0, stats);
+    check_phase("resync", 0, stats, subscriptions, false, 0, phase_ms);
+
+    if ((int)stats.values.size() != desired)
+    {
+        fprintf(stderr, "resync: received %zu of %d paths\n", stats.values.size(), desired);
+        failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int cycles = 3;
+    int phase_ms = 1500;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s STANDIN [--cycles N] [--phase MS]\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc)
+        {
+            cycles = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--phase") == 0 && i + 1 < argc)
+        {
+            phase_ms = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s STANDIN [--cycles N] [--phase MS]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // view 0: navigation, view 1: environment, low power: battery voltage (like notifications on the watch)
+    std::map<String, SignalKSubscription *> subscriptions;
+    const char *view_paths[2][3] = {
+        {"navigation.speedOverGround", "navigation.courseOverGroundTrue", "navigation.headingMagnetic"},
+        {"environment.depth.belowTransducer", "environment.wind.speedApparent", "environment.wind.angleApparent"}};
+    for (int view = 0; view < 2; view++)
+    {
+        for (auto path : view_paths[view])
+        {
+            auto subscription = new SignalKSubscription(path, VIEW_PERIOD, false);
+            subscription->add_view(view);
+            subscriptions[path] = subscription;
+        }
+    }
+    subscriptions["electrical.batteries.house.voltage"] = new SignalKSubscription("electrical.batteries.house.voltage", LOW_POWER_PERIOD, true);
+
+    int port = 20000 + getpid() % 20000;
+    pid_t standin = start_standin(argv[1], port);
+    int fd = connect_stream(port);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Unable to connect to stand-in on port %d\n", port);
+        kill(standin, SIGTERM);
+        return 1;
+    }
+
+    StreamReader reader(fd);
+    PhaseStats_t hello;
+    reader.receive(100, 0, hello);
+
+    const char *phase_names[] = {"view 0", "view 1", "sleep"};
+    std::vector<PhaseStats_t> first_cycle(3);
+    bool connected = true;
+
+    printf("phase   cycle  sent B  received B\n");
+    for (int cycle = 1; cycle <= cycles && connected; cycle++)
+    {
+        for (int phase = 0; phase < 3 && connected; phase++)
+        {
+            bool is_lp = phase == 2;
+            int view = phase == 2 ? 0 : phase;
+            PhaseStats_t stats;
+
+            stats.tx_bytes = send_changes(fd, subscriptions, is_lp, view);
+            connected = reader.receive(phase_ms, SETTLE_MS, stats);
+            check_phase(phase_names[phase], cycle, stats, subscriptions, is_lp, view, phase_ms);
+            printf("%-7s %5d  %6u  %10u\n", phase_names[phase], cycle, stats.tx_bytes, stats.rx_bytes);
+
+            if (cycle == 1)
+            {
+                first_cycle[phase] = stats;
+            }
+            else if (stats.rx_bytes > first_cycle[phase].rx_bytes * 3 / 2 + 512)
+            {
+                fprintf(stderr, "cycle %d %s: received %u bytes, first cycle %u (subscriptions pile up on the server)\n", cycle,
+                        phase_names[phase], stats.rx_bytes, first_cycle[phase].rx_bytes);
+                failures++;
+            }
+
+            if (is_lp && stats.values.empty())
+            {
+                fprintf(stderr, "cycle %d: low power path wasn't received in sleep\n", cycle);
+                failures++;
+            }
+        }
+    }
+
+    if (connected)
+    {
+        check_resync(fd, reader, subscriptions, phase_ms);
+    }
+
+    close(fd);
+    kill(standin, SIGTERM);
+    waitpid(standin, NULL, 0);
+
+    if (!connected)
+    {
+        fprintf(stderr, "Stand-in closed the connection\n");
+        failures++;
+    }
+
+    for (auto subscription : subscriptions)
+    {
+        delete subscription.second;
+    }
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("subscription traffic: no stale or duplicate subscriptions\n");
+    return 0;
+}
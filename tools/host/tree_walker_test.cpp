@@ -0,0 +1,311 @@
+/*
+ * Host test of SignalKTreeWalker. Full data model (like REST response of /signalk/v1/api/vessels/self) is fed
+ * in chunks of every size from 1 byte, values found by the walker must be the same as the ones found by
+ * simple recursive walk of the whole buffer (TreeOracle).
+ */
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "networking/signalk_tree_walker.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(condition))                                                         \
+        {                                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                           \
+        }                                                                         \
+    } while (0)
+
+typedef std::vector<std::pair<std::string, std::string>> Values_t;
+
+static std::string make_model()
+{
+    std::string ret = "{\n  \"uuid\": \"urn:mrn:signalk:uuid:c0d79334\", \"name\": \"Stand {in}\",\n"
+                      "  \"navigation\": {\n"
+                      "    \"speedOverGround\": {\"meta\": {\"units\": \"m/s\", \"value\": 99}, \"value\": 3.85, \"timestamp\": \"2024-05-01T10:00:00Z\",\n"
+                      "      \"$source\": \"n2k.1\", \"values\": {\"n2k.1\": {\"value\": 3.85}, \"n2k.2\": {\"value\": 3.9}}},\n"
+                      "    \"position\": {\"value\": {\"longitude\": 24.956789, \"latitude\": 60.16789, \"altitude\": 12.5}, \"timestamp\": \"x\"},\n"
+                      "    \"state\": {\"value\":\"sailing \\\"fast\\\" } [\" },\n"
+                      "    \"anchor\": {\"position\": {\"value\": null}, \"maxRadius\": {\"value\": -1.5e2}},\n"
+                      "    \"lights\": {\"value\": true}\n"
+                      "  },\n"
+                      "  \"environment\": {\"depth\": {\"belowKeel\": {\"value\": 4.2}}, \"mode\": {\"value\": \"day\"},\n"
+                      "    \"outside\": {\"pressure\": {\"value\": 101325}, \"tags\": {\"value\": [1, [2, 3], {\"a\": \"]\"}]}}},\n"
+                      "  \"notifications\": {\"mob\": {\"value\": {\"state\": \"normal\", \"method\": [\"visual\"], \"message\": \"{ok}\"}}}";
+
+    // many similar paths, like large vessel
+    char buffer[160];
+    ret += ",\n  \"electrical\": {\"batteries\": {";
+    for (int i = 0; i < 40; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "%s\"bank%d\": {\"voltage\": {\"value\": 12.%d}, \"current\": {\"value\": -%d.25}}", i > 0 ? ", " : "", i, i, i);
+        ret += buffer;
+    }
+    ret += "}}\n}\n";
+
+    return ret;
+}
+
+/// Recursive walk of the whole data model in one buffer, reference for the incremental walker
+class TreeOracle
+{
+public:
+    TreeOracle(const std::string &model) : model_(model) {}
+
+    bool walk(Values_t &values)
+    {
+        pos_ = 0;
+        return walk_object("", values) && (skip_whitespace(), pos_ == model_.size());
+    }
+
+private:
+    const std::string &model_;
+    size_t pos_ = 0;
+
+    void skip_whitespace()
+    {
+        while (pos_ < model_.size() && strchr(" \t\r\n", model_[pos_]) != NULL)
+        {
+            pos_++;
+        }
+    }
+
+    bool consume(char c)
+    {
+        skip_whitespace();
+        if (pos_ < model_.size() && model_[pos_] == c)
+        {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    /// Reads string with its escape sequences as they are
+    bool read_string(std::string &str)
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+        size_t start = pos_;
+        while (pos_ < model_.size() && model_[pos_] != '"')
+        {
+            pos_ += model_[pos_] == '\\' ? 2 : 1;
+        }
+        if (pos_ >= model_.size())
+        {
+            return false;
+        }
+        str = model_.substr(start, pos_ - start);
+        pos_++;
+        return true;
+    }
+
+    /// Skips any value and returns its raw JSON
+    bool skip_value(std::string &raw)
+    {
+        skip_whitespace();
+        size_t start = pos_;
+        std::string str;
+
+        if (pos_ >= model_.size())
+        {
+            return false;
+        }
+        else if (model_[pos_] == '"')
+        {
+            if (!read_string(str))
+            {
+                return false;
+            }
+        }
+        else if (model_[pos_] == '{' || model_[pos_] == '[')
+        {
+            char close = model_[pos_] == '{' ? '}' : ']';
+            pos_++;
+            if (!consume(close))
+            {
+                do
+                {
+                    if (close == '}' && (!read_string(str) || !consume(':')))
+                    {
+                        return false;
+                    }
+                    if (!skip_value(str))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+
+                if (!consume(close))
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            while (pos_ < model_.size() && strchr(",}] \t\r\n", model_[pos_]) == NULL)
+            {
+                pos_++;
+            }
+        }
+
+        raw = model_.substr(start, pos_ - start);
+        return pos_ > start;
+    }
+
+    bool walk_object(const std::string &path, Values_t &values)
+    {
+        if (!consume('{'))
+        {
+            return false;
+        }
+        if (consume('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            std::string key;
+            std::string raw;
+            if (!read_string(key) || !consume(':'))
+            {
+                return false;
+            }
+            skip_whitespace();
+
+            if (!path.empty() && key == "value")
+            {
+                if (!skip_value(raw))
+                {
+                    return false;
+                }
+                values.push_back(std::make_pair(path, raw));
+            }
+            else if (pos_ < model_.size() && model_[pos_] == '{' && key != "meta" && key != "values" &&
+                     (path.empty() ? key : path + "." + key).size() < SK_TREE_PATH_MAX)
+            {
+                if (!walk_object(path.empty() ? key : path + "." + key, values))
+                {
+                    return false;
+                }
+            }
+            else if (!skip_value(raw))
+            {
+                return false;
+            }
+        } while (consume(','));
+
+        return consume('}');
+    }
+};
+
+static Values_t parse_whole(const std::string &model)
+{
+    Values_t ret;
+    TreeOracle oracle(model);
+    CHECK(oracle.walk(ret));
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+static Values_t walk_chunks(const std::string &model, size_t chunk, bool &complete, int max_value = SK_TREE_VALUE_MAX)
+{
+    Values_t ret;
+    SignalKTreeWalker walker([&ret](const SignalKDeltaValue_t &value)
+                             {
+                                 CHECK(value.path[value.path_len] == '\0');
+                                 ret.push_back(std::make_pair(std::string(value.path, value.path_len), std::string(value.value, value.value_len)));
+                             },
+                             max_value);
+
+    for (size_t offset = 0; offset < model.size(); offset += chunk)
+    {
+        std::string data = model.substr(offset, chunk);
+        CHECK(walker.feed(data.data(), data.size()));
+    }
+
+    complete = walker.is_complete();
+    CHECK(walker.get_value_count() == (int)ret.size());
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+static void test_chunked_model()
+{
+    std::string model = make_model();
+    Values_t expected = parse_whole(model);
+    int walks = 0;
+
+    CHECK(expected.size() == 91);
+
+    for (size_t chunk = 1; chunk <= model.size(); chunk += (chunk < 80 ? 1 : 97))
+    {
+        bool complete = false;
+        Values_t values = walk_chunks(model, chunk, complete);
+        CHECK(complete);
+        CHECK(values == expected);
+        if (values != expected)
+        {
+            fprintf(stderr, "chunk %zu: %zu values, expected %zu\n", chunk, values.size(), expected.size());
+            break;
+        }
+        walks++;
+    }
+
+    printf("chunked model: %zu bytes, %zu values, %d chunk sizes\n", model.size(), expected.size(), walks);
+}
+
+static void test_large_value_is_skipped()
+{
+    std::string model = "{\"navigation\": {\"position\": {\"value\": {\"longitude\": 24.956789, \"latitude\": 60.16789}}, \"speedOverGround\": {\"value\": 3.5}}}";
+    bool complete = false;
+    Values_t values = walk_chunks(model, 7, complete, 16);
+
+    CHECK(complete);
+    CHECK(values.size() == 1 && values[0].first == "navigation.speedOverGround" && values[0].second == "3.5");
+}
+
+static void test_invalid_document()
+{
+    const char *invalid[] = {"[1, 2]", "{\"a\": {\"value\": }}", "{\"a\" {\"value\": 1}}", "{\"a\": {\"value\": 1}, ]"};
+
+    for (auto text : invalid)
+    {
+        SignalKTreeWalker walker([](const SignalKDeltaValue_t &) {});
+        CHECK(!walker.feed(text, strlen(text)));
+        CHECK(!walker.is_complete());
+    }
+
+    // truncated response - values received so far are walked, but document isn't complete
+    std::string model = make_model();
+    bool complete = true;
+    Values_t values = walk_chunks(model.substr(0, model.size() / 2), 100, complete);
+    CHECK(!complete);
+    CHECK(!values.empty());
+}
+
+int main()
+{
+    test_chunked_model();
+    test_large_value_is_skipped();
+    test_invalid_document();
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("tree walker: all checks passed\n");
+    return 0;
+}
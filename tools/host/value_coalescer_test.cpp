@@ -0,0 +1,277 @@
+/*
+ * Host stress test of SignalKValueCoalescer (GUI value slots). Two producer threads (websocket task and REST
+ * snapshot / cache) post values of their own paths as fast as they can, consumer thread (GUI task) reads them.
+ * Every value carries its path and sequence number in all fields, so the test checks that nothing is lost
+ * (latest value of every path is delivered), nothing is torn (fields of one update are from the same post,
+ * spilled JSON included) and values of a path are never delivered out of order. Values which don't fit inline
+ * storage have to be rejected by SignalKValue_t::parse (so they are spilled), never truncated, and string escapes
+ * (\uXXXX including surrogate pairs) have to be decoded to UTF-8.
+ *
+ *    ./value_coalescer_test --posts 200000
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "system/value_coalescer.h"
+#include "system/psram.h"
+
+#define TEST_PATHS 32
+#define TEST_PRODUCERS 2
+#define TEST_SPILL_EVERY 7
+
+static std::atomic<int> failures(0);
+
+static void fail(const char *message, int path, uint32_t seq)
+{
+    if (failures.fetch_add(1) < 10)
+    {
+        fprintf(stderr, "%s (path=%d, seq=%u)\n", message, path, seq);
+    }
+}
+
+static bool check_parse()
+{
+    SignalKValue_t value;
+    bool ret = true;
+
+    const char *short_text = "\"Port tack\"";
+    if (!value.parse(short_text, strlen(short_text)) || value.type != SK_VALUE_STRING || strcmp(value.text, "Port tack") != 0)
+    {
+        fprintf(stderr, "Short string isn't parsed inline\n");
+        ret = false;
+    }
+
+    std::string long_text = "\"" + std::string(SK_VALUE_TEXT_MAX + 10, 'x') + "\"";
+    if (value.parse(long_text.c_str(), long_text.size()))
+    {
+        fprintf(stderr, "Long string is truncated instead of spilled (%s)\n", value.text);
+        ret = false;
+    }
+
+    const char *position = "{\"longitude\":24.956789012,\"latitude\":60.167890123,\"altitude\":12.500000}";
+    if (value.parse(position, strlen(position)))
+    {
+        fprintf(stderr, "Position with altitude (%d bytes) isn't rejected\n", (int)strlen(position));
+        ret = false;
+    }
+
+    struct
+    {
+        const char *json;
+        const char *text; // NULL if the value has to be rejected
+    } escapes[] = {
+        {"\"a\\\"b\\\\c\\/d\"", "a\"b\\c/d"},
+        {"\"\\b\\f\\n\\r\\t\"", "\b\f\n\r\t"},
+        {"\"\\u0041\\u00e9\\u20AC\"", "A\xc3\xa9\xe2\x82\xac"},        // A, e acute, euro sign
+        {"\"\\ud83d\\ude80 go\"", "\xf0\x9f\x9a\x80 go"},              // surrogate pair (rocket)
+        {"\"\\ud83dx\"", "\xef\xbf\xbdx"},                               // lone high surrogate
+        {"\"\\ude80\"", "\xef\xbf\xbd"},                                 // lone low surrogate
+        {"\"\\u00g1\"", NULL},                                           // not hex
+        {"\"\\u00\"", NULL},                                             // cut escape
+        {"\"ab\\\"", NULL},                                              // escape at the end
+        {"\"\\x41\"", NULL},                                             // unknown escape
+    };
+
+    for (auto &escape : escapes)
+    {
+        bool parsed = value.parse(escape.json, strlen(escape.json));
+        if (escape.text == NULL ? parsed : (!parsed || value.type != SK_VALUE_STRING || strcmp(value.text, escape.text) != 0))
+        {
+            fprintf(stderr, "String %s isn't decoded right (parsed=%d, text=%s)\n", escape.json, (int)parsed, value.text);
+            ret = false;
+        }
+    }
+
+    // multi-byte characters count with their UTF-8 length
+    std::string euros = "\"";
+    for (int i = 0; i < SK_VALUE_TEXT_MAX / 3; i++)
+    {
+        euros += "\\u20ac";
+    }
+    euros += "\"";
+    if (!value.parse(euros.c_str(), euros.size()) || strlen(value.text) != (SK_VALUE_TEXT_MAX / 3) * 3)
+    {
+        fprintf(stderr, "%d euro signs aren't parsed inline\n", SK_VALUE_TEXT_MAX / 3);
+        ret = false;
+    }
+    euros.insert(1, "\\u20ac");
+    if (value.parse(euros.c_str(), euros.size()))
+    {
+        fprintf(stderr, "%d euro signs aren't rejected\n", SK_VALUE_TEXT_MAX / 3 + 1);
+        ret = false;
+    }
+
+    return ret;
+}
+
+static void producer(SignalKValueCoalescer &coalescer, int first_path, int posts, uint32_t *last_posted)
+{
+    int paths = TEST_PATHS / TEST_PRODUCERS;
+
+    for (int i = 1; i <= posts; i++)
+    {
+        int path = first_path + (i * 7 + i / 3) % paths;
+        uint32_t seq = (uint32_t)i;
+        SignalKUpdate_t update;
+        char *spill = NULL;
+
+        update.path_id = path;
+        update.timestamp = seq;
+
+        if (i % TEST_SPILL_EVERY == 0)
+        {
+            // large value, e.g. position with altitude or long string
+            spill = (char *)twatchsk::psram_malloc(SK_VALUE_TEXT_MAX * 2);
+            snprintf(spill, SK_VALUE_TEXT_MAX * 2, "{\"path\":%d,\"seq\":%u,\"longitude\":24.956789,\"latitude\":60.167890,\"altitude\":12.5}", path, seq);
+            update.value.type = SK_VALUE_SPILLED;
+            update.value.text[0] = '\0';
+        }
+        else
+        {
+            update.value.type = SK_VALUE_STRING;
+            snprintf(update.value.text, SK_VALUE_TEXT_MAX, "path %d seq %u", path, seq);
+        }
+
+        coalescer.post(update, spill);
+        last_posted[path] = seq;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int posts = 200000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--posts") == 0 && i + 1 < argc)
+        {
+            posts = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--posts N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!check_parse())
+    {
+        failures++;
+    }
+
+    SignalKValueCoalescer coalescer;
+    if (!coalescer.init())
+    {
+        fprintf(stderr, "Unable to allocate slots\n");
+        return 1;
+    }
+
+    uint32_t last_posted[TEST_PATHS] = {0};
+    uint32_t last_read[TEST_PATHS] = {0};
+    std::atomic<int> running(TEST_PRODUCERS);
+    uint32_t reads = 0;
+    uint32_t spills = 0;
+
+    auto consume = [&]()
+    {
+        SignalKUpdate_t update;
+        char *spill;
+
+        while (coalescer.read(update, &spill))
+        {
+            int path = update.path_id;
+            uint32_t seq = update.timestamp;
+            char expected[SK_VALUE_TEXT_MAX * 2];
+            reads++;
+
+            if (path >= TEST_PATHS)
+            {
+                fail("Unknown path", path, seq);
+                twatchsk::psram_free(spill);
+                continue;
+            }
+
+            if (seq <= last_read[path])
+            {
+                fail("Value delivered out of order or twice", path, seq);
+            }
+            last_read[path] = seq;
+
+            if (update.value.type == SK_VALUE_SPILLED)
+            {
+                spills++;
+                snprintf(expected, sizeof(expected), "{\"path\":%d,\"seq\":%u,", path, seq);
+                if (spill == NULL || strncmp(spill, expected, strlen(expected)) != 0)
+                {
+                    fail("Torn spilled value", path, seq);
+                }
+            }
+            else
+            {
+                snprintf(expected, sizeof(expected), "path %d seq %u", path, seq);
+                if (spill != NULL || update.value.type != SK_VALUE_STRING || strcmp(update.value.text, expected) != 0)
+                {
+                    fail("Torn value", path, seq);
+                }
+            }
+
+            twatchsk::psram_free(spill);
+        }
+    };
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < TEST_PRODUCERS; i++)
+    {
+        producers.push_back(std::thread([&, i]()
+                                        {
+                                            producer(coalescer, i * TEST_PATHS / TEST_PRODUCERS, posts, last_posted);
+                                            running--;
+                                        }));
+    }
+
+    std::thread consumer([&]()
+                         {
+                             while (running > 0)
+                             {
+                                 consume();
+                             }
+                             // values posted after last read
+                             consume();
+                         });
+
+    for (auto &thread : producers)
+    {
+        thread.join();
+    }
+    consumer.join();
+
+    for (int path = 0; path < TEST_PATHS; path++)
+    {
+        if (last_read[path] != last_posted[path])
+        {
+            fail("Latest value lost", path, last_posted[path]);
+        }
+    }
+
+    uint32_t total = (uint32_t)posts * TEST_PRODUCERS;
+    if (coalescer.get_delivered_count() + coalescer.get_coalesced_count() != total)
+    {
+        fprintf(stderr, "Delivered %u + coalesced %u != posted %u\n", coalescer.get_delivered_count(), coalescer.get_coalesced_count(), total);
+        failures++;
+    }
+
+    printf("posted %u, delivered %u (%u spilled), coalesced %u\n", total, reads, spills, coalescer.get_coalesced_count());
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures.load());
+        return 1;
+    }
+
+    printf("value coalescer: nothing lost or torn\n");
+    return 0;
+}
@@ -0,0 +1,1480 @@
+/*
+ * SignalK stand-in server for integration and load testing of TWatchSK without real signalk-server.
+ *
+ * It implements only what the watch uses:
+ *  - websocket stream /signalk/v1/stream (hello, subscribe with period, unsubscribe, access requests, PUT requests)
+ *    Subscriptions behave like in signalk-server: repeated subscribe of the same path adds another subscription
+ *    (values are sent for each of them) and only {"context":"*","unsubscribe":[{"path":"*"}]} is honoured
+ *  - REST /signalk, /signalk/v1/api/vessels/self (full data model snapshot)
+ *  - view download /signalk/v1/applicationData/global/twatch/1.0/ui/default (serves file set by --view)
+ *
+ * Build and run on Linux (no dependencies):
+ *    g++ -std=c++11 -O2 -pthread -o signalk_standin tools/signalk_standin.cpp
+ *    ./signalk_standin --port 3000 --paths 50 --rate 100
+ *
+ * Options:
+ *    --port N             listening port (default 3000)
+ *    --paths N            number of generated paths, first ones are real SignalK paths (default 20)
+ *    --rate N             deltas per second sent to every client, 0 = honour subscription periods (default 0)
+ *    --values N           values in one delta when --rate is used (default 1)
+ *    --fragment N         split every websocket message into continuation frames of N bytes (default 0 = off)
+ *    --chunk N            write every websocket frame to TCP in N byte chunks with 2 ms gaps (default 0 = off)
+ *    --approve MODE       access request result: auto, deny or none (never answered) (default auto)
+ *    --approve-delay MS   delay before access request is approved or denied (default 1000)
+ *    --require-token      stream and REST API require valid token (tokens issued by access requests or --token)
+ *    --token TOKEN        pre-issued valid token
+ *    --drop-every S       disconnect all websocket clients every S seconds (default 0 = never)
+ *    --drop-mode MODE     abrupt (TCP reset) or close (websocket close frame 1001) (default abrupt)
+ *    --notify-every S     toggle notifications.standin.alarm between alarm and normal every S seconds (default 0 = off)
+ *    --ais N              send N deltas per second of 100 AIS targets (other vessels), as server which ignores
+ *                         subscription context (default 0 = off)
+ *    --stall S            S seconds after client connects stop sending deltas and answering pings, but keep TCP
+ *                         connection open - tests liveness detection of the watch (default 0 = off)
+ *    --view FILE          file served as TWatchSK view definition (default data/sk_view.json)
+ *    --verbose            log every websocket message
+ *
+ * Every ping received from the watch is logged with time since previous one, so keepalive interval of the watch
+ * can be measured (stats line shows pings per minute of all clients).
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char *SELF_CONTEXT = "vessels.urn:mrn:signalk:uuid:c0d79334-4e25-4245-8892-54e8ccc8021d";
+
+struct Options_t
+{
+    int port = 3000;
+    int paths = 20;
+    int rate = 0;
+    int values = 1;
+    int fragment = 0;
+    int chunk = 0;
+    std::string approve = "auto";
+    int approve_delay = 1000;
+    bool require_token = false;
+    int drop_every = 0;
+    std::string drop_mode = "abrupt";
+    int notify_every = 0;
+    int ais = 0;
+    int stall = 0;
+    std::string view = "data/sk_view.json";
+    bool verbose = false;
+};
+
+static Options_t options;
+
+static uint64_t now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string iso_timestamp()
+{
+    char buffer[32];
+    auto now = std::chrono::system_clock::now();
+    time_t seconds = std::chrono::system_clock::to_time_t(now);
+    int millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%03dZ", millis);
+    return buffer;
+}
+
+static std::string json_escape(const std::string &text)
+{
+    std::string ret;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            ret += '\\';
+            ret += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            ret += buffer;
+        }
+        else
+        {
+            ret += c;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Minimal JSON reader - enough for messages sent by the watch (subscribe, unsubscribe, accessRequest, put).
+ */
+struct JsonValue_t
+{
+    enum Type_t
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    } type = Null;
+    bool boolean = false;
+    double number = 0;
+    std::string text; // string value or raw JSON text of any value
+    std::vector<JsonValue_t> items;
+    std::vector<std::pair<std::string, JsonValue_t>> members;
+
+    const JsonValue_t *get(const char *key) const
+    {
+        for (auto &member : members)
+        {
+            if (member.first == key)
+            {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string get_string(const char *key, const std::string &fallback = "") const
+    {
+        auto value = get(key);
+        return value != nullptr && value->type == String ? value->text : fallback;
+    }
+};
+
+class JsonReader
+{
+public:
+    JsonReader(const std::string &text) : text_(text) {}
+
+    bool parse(JsonValue_t &value)
+    {
+        return parse_value(value) && (skip_whitespace(), pos_ == text_.size());
+    }
+
+private:
+    const std::string &text_;
+    size_t pos_ = 0;
+
+    void skip_whitespace()
+    {
+        while (pos_ < text_.size() && isspace((unsigned char)text_[pos_]))
+        {
+            pos_++;
+        }
+    }
+
+    bool parse_string(std::string &out)
+    {
+        if (text_[pos_] != '"')
+        {
+            return false;
+        }
+        pos_++;
+        while (pos_ < text_.size() && text_[pos_] != '"')
+        {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size())
+            {
+                pos_++;
+                char c = text_[pos_];
+                out += c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c;
+            }
+            else
+            {
+                out += text_[pos_];
+            }
+            pos_++;
+        }
+        if (pos_ >= text_.size())
+        {
+            return false;
+        }
+        pos_++;
+        return true;
+    }
+
+    bool parse_value(JsonValue_t &value)
+    {
+        skip_whitespace();
+        if (pos_ >= text_.size())
+        {
+            return false;
+        }
+
+        size_t start = pos_;
+        char c = text_[pos_];
+        bool ret = true;
+
+        if (c == '{')
+        {
+            value.type = JsonValue_t::Object;
+            pos_++;
+            skip_whitespace();
+            if (pos_ < text_.size() && text_[pos_] == '}')
+            {
+                pos_++;
+            }
+            else
+            {
+                while (ret)
+                {
+                    skip_whitespace();
+                    std::string key;
+                    JsonValue_t member;
+                    ret = pos_ < text_.size() && parse_string(key);
+                    skip_whitespace();
+                    ret = ret && pos_ < text_.size() && text_[pos_++] == ':' && parse_value(member);
+                    if (ret)
+                    {
+                        value.members.push_back(std::make_pair(key, member));
+                        skip_whitespace();
+                        if (pos_ < text_.size() && text_[pos_] == ',')
+                        {
+                            pos_++;
+                            continue;
+                        }
+                        ret = pos_ < text_.size() && text_[pos_++] == '}';
+                        break;
+                    }
+                }
+            }
+        }
+        else if (c == '[')
+        {
+            value.type = JsonValue_t::Array;
+            pos_++;
+            skip_whitespace();
+            if (pos_ < text_.size() && text_[pos_] == ']')
+            {
+                pos_++;
+            }
+            else
+            {
+                while (ret)
+                {
+                    JsonValue_t item;
+                    ret = parse_value(item);
+                    if (ret)
+                    {
+                        value.items.push_back(item);
+                        skip_whitespace();
+                        if (pos_ < text_.size() && text_[pos_] == ',')
+                        {
+                            pos_++;
+                            continue;
+                        }
+                        ret = pos_ < text_.size() && text_[pos_++] == ']';
+                        break;
+                    }
+                }
+            }
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue_t::String;
+            std::string str;
+            ret = parse_string(str);
+            value.text = str;
+            return ret;
+        }
+        else if (text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 5, "false") == 0)
+        {
+            value.type = JsonValue_t::Bool;
+            value.boolean = c == 't';
+            pos_ += value.boolean ? 4 : 5;
+        }
+        else if (text_.compare(pos_, 4, "null") == 0)
+        {
+            pos_ += 4;
+        }
+        else
+        {
+            char *end = nullptr;
+            value.type = JsonValue_t::Number;
+            value.number = strtod(text_.c_str() + pos_, &end);
+            ret = end != text_.c_str() + pos_;
+            pos_ = end - text_.c_str();
+        }
+
+        if (ret && value.type != JsonValue_t::String)
+        {
+            value.text = text_.substr(start, pos_ - start);
+        }
+
+        return ret;
+    }
+};
+
+/*
+ * SHA-1 and base64 for websocket handshake (RFC 6455).
+ */
+static std::string sha1(const std::string &input)
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string message = input;
+    uint64_t bit_len = (uint64_t)input.size() * 8;
+    message += (char)0x80;
+    while (message.size() % 64 != 56)
+    {
+        message += (char)0;
+    }
+    for (int i = 7; i >= 0; i--)
+    {
+        message += (char)((bit_len >> (i * 8)) & 0xFF);
+    }
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+        {
+            w[i] = ((uint8_t)message[chunk + i * 4] << 24) | ((uint8_t)message[chunk + i * 4 + 1] << 16) |
+                   ((uint8_t)message[chunk + i * 4 + 2] << 8) | (uint8_t)message[chunk + i * 4 + 3];
+        }
+        for (int i = 16; i < 80; i++)
+        {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = (x << 1) | (x >> 31);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f, k;
+            if (i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::string ret;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            ret += (char)((h[i] >> (j * 8)) & 0xFF);
+        }
+    }
+    return ret;
+}
+
+static std::string base64(const std::string &input)
+{
+    static const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string ret;
+    size_t i = 0;
+    for (; i + 2 < input.size(); i += 3)
+    {
+        uint32_t n = ((uint8_t)input[i] << 16) | ((uint8_t)input[i + 1] << 8) | (uint8_t)input[i + 2];
+        ret += table[(n >> 18) & 63];
+        ret += table[(n >> 12) & 63];
+        ret += table[(n >> 6) & 63];
+        ret += table[n & 63];
+    }
+    if (i < input.size())
+    {
+        uint32_t n = (uint8_t)input[i] << 16;
+        if (i + 1 < input.size())
+        {
+            n |= (uint8_t)input[i + 1] << 8;
+        }
+        ret += table[(n >> 18) & 63];
+        ret += table[(n >> 12) & 63];
+        ret += i + 1 < input.size() ? table[(n >> 6) & 63] : '=';
+        ret += '=';
+    }
+    return ret;
+}
+
+/*
+ * Data model - generated paths with random walk values.
+ */
+struct ModelPath_t
+{
+    std::string path;
+    std::string value; // raw JSON
+    double number;
+    double minimum;
+    double maximum;
+};
+
+class Model
+{
+public:
+    void generate(int count)
+    {
+        struct
+        {
+            const char *path;
+            double minimum;
+            double maximum;
+        } known[] = {
+            {"navigation.speedOverGround", 0, 8},
+            {"navigation.courseOverGroundTrue", 0, 6.28},
+            {"navigation.headingMagnetic", 0, 6.28},
+            {"environment.depth.belowTransducer", 2, 30},
+            {"environment.wind.speedApparent", 0, 20},
+            {"environment.wind.angleApparent", -3.14, 3.14},
+            {"environment.outside.temperature", 270, 310},
+            {"environment.water.temperature", 275, 300},
+            {"electrical.batteries.house.voltage", 11.5, 14.4},
+            {"electrical.batteries.house.current", -20, 30},
+            {"propulsion.main.revolutions", 0, 50},
+        };
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        int known_count = sizeof(known) / sizeof(known[0]);
+        for (int i = 0; i < count; i++)
+        {
+            ModelPath_t path;
+            if (i < known_count)
+            {
+                path.path = known[i].path;
+                path.minimum = known[i].minimum;
+                path.maximum = known[i].maximum;
+            }
+            else
+            {
+                path.path = "standin.value" + std::to_string(i - known_count);
+                path.minimum = 0;
+                path.maximum = 100;
+            }
+            path.number = (path.minimum + path.maximum) / 2;
+            path.value = format_number(path.number);
+            paths_.push_back(path);
+        }
+
+        ModelPath_t mode;
+        mode.path = "environment.mode";
+        mode.value = "\"day\"";
+        paths_.push_back(mode);
+
+        ModelPath_t light;
+        light.path = "electrical.switches.anchorLight.state";
+        light.value = "false";
+        paths_.push_back(light);
+    }
+
+    /// Moves value of the path and returns it as raw JSON, returns empty string if path doesn't exist
+    std::string next_value(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &item : paths_)
+        {
+            if (item.path == path)
+            {
+                if (item.maximum > item.minimum)
+                {
+                    double step = (item.maximum - item.minimum) * 0.02 * ((rand() % 201) - 100) / 100.0;
+                    item.number += step;
+                    if (item.number < item.minimum || item.number > item.maximum)
+                    {
+                        item.number -= 2 * step;
+                    }
+                    item.value = format_number(item.number);
+                }
+                return item.value;
+            }
+        }
+        return "";
+    }
+
+    bool set_value(const std::string &path, const std::string &value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &item : paths_)
+        {
+            if (item.path == path)
+            {
+                item.value = value;
+                item.number = atof(value.c_str());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::string> get_paths()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> ret;
+        for (auto &item : paths_)
+        {
+            ret.push_back(item.path);
+        }
+        return ret;
+    }
+
+    /// Full data model of the vessel in the same shape as /signalk/v1/api/vessels/self returns
+    std::string to_json()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto timestamp = iso_timestamp();
+        // build nested tree from dotted paths
+        std::map<std::string, std::string> leaves;
+        for (auto &item : paths_)
+        {
+            leaves[item.path] = "{\"value\":" + item.value + ",\"$source\":\"standin\",\"timestamp\":\"" + timestamp + "\"}";
+        }
+        return "{\"uuid\":\"" + std::string(SELF_CONTEXT + 8) + "\",\"name\":\"Stand-in\"," + build_tree(leaves, "") + "}";
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<ModelPath_t> paths_;
+
+    static std::string format_number(double number)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.3f", number);
+        return buffer;
+    }
+
+    static std::string build_tree(const std::map<std::string, std::string> &leaves, const std::string &prefix)
+    {
+        std::string ret;
+        std::set<std::string> children;
+        for (auto &leaf : leaves)
+        {
+            if (leaf.first.compare(0, prefix.size(), prefix) != 0)
+            {
+                continue;
+            }
+            auto rest = leaf.first.substr(prefix.size());
+            auto dot = rest.find('.');
+            auto key = rest.substr(0, dot);
+            if (children.count(key))
+            {
+                continue;
+            }
+            children.insert(key);
+            if (!ret.empty())
+            {
+                ret += ",";
+            }
+            if (dot == std::string::npos)
+            {
+                ret += "\"" + key + "\":" + leaf.second;
+            }
+            else
+            {
+                ret += "\"" + key + "\":{" + build_tree(leaves, prefix + key + ".") + "}";
+            }
+        }
+        return ret;
+    }
+};
+
+static Model model;
+static std::mutex tokens_mutex;
+static std::set<std::string> tokens;
+static std::atomic<uint32_t> token_counter(0);
+static std::atomic<uint64_t> stat_deltas(0);
+static std::atomic<uint64_t> stat_bytes(0);
+static std::atomic<int> stat_clients(0);
+static std::atomic<uint32_t> stat_connections(0);
+static std::atomic<uint64_t> stat_pings(0);
+static std::atomic<uint32_t> drop_generation(0);
+static std::atomic<uint32_t> notification_generation(0);
+
+static bool is_token_valid(const std::string &token)
+{
+    if (!options.require_token)
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(tokens_mutex);
+    return tokens.count(token) > 0;
+}
+
+static bool send_all(int fd, const char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t received = recv(fd, data, length, 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+        data += received;
+        length -= received;
+    }
+    return true;
+}
+
+static std::string query_param(const std::string &target, const std::string &name)
+{
+    auto query = target.find('?');
+    if (query == std::string::npos)
+    {
+        return "";
+    }
+    std::stringstream stream(target.substr(query + 1));
+    std::string pair;
+    while (std::getline(stream, pair, '&'))
+    {
+        auto eq = pair.find('=');
+        if (pair.substr(0, eq) == name)
+        {
+            return eq == std::string::npos ? "" : pair.substr(eq + 1);
+        }
+    }
+    return "";
+}
+
+/*
+ * Websocket session of single client.
+ */
+struct Subscription_t
+{
+    uint32_t period;
+    uint64_t next_send;
+};
+
+class WebsocketSession
+{
+public:
+    WebsocketSession(int fd, const std::string &token, int id) : fd_(fd), token_(token), id_(id) {}
+
+    void run()
+    {
+        stat_clients++;
+        send_text("{\"name\":\"signalk-standin\",\"version\":\"1.0.0\",\"self\":\"" + std::string(SELF_CONTEXT) +
+                  "\",\"roles\":[\"master\",\"main\"],\"timestamp\":\"" + iso_timestamp() + "\"}");
+
+        std::thread generator(&WebsocketSession::generate, this);
+        receive();
+        running_ = false;
+        generator.join();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+        close(fd_);
+        stat_clients--;
+        if (pings_ > 1)
+        {
+            printf("[%d] client disconnected, %u pings, average interval %.1f s\n", id_, pings_,
+                   (last_ping_ms_ - first_ping_ms_) / 1000.0 / (pings_ - 1));
+        }
+        else
+        {
+            printf("[%d] client disconnected\n", id_);
+        }
+    }
+
+private:
+    int fd_;
+    std::string token_;
+    int id_;
+    std::atomic<bool> running_{true};
+    uint64_t connected_ms_ = now_ms();
+    uint64_t first_ping_ms_ = 0;
+    uint64_t last_ping_ms_ = 0;
+    uint32_t pings_ = 0;
+    std::mutex token_mutex_;
+    std::mutex send_mutex_;
+    std::mutex subscriptions_mutex_;
+    std::multimap<std::string, Subscription_t> subscriptions_; // not merged, as in signalk-server
+    std::vector<std::thread> workers_;
+
+    /// Server pretends it's dead (see --stall)
+    bool is_stalled()
+    {
+        return options.stall > 0 && now_ms() - connected_ms_ >= (uint64_t)options.stall * 1000;
+    }
+
+    void handle_ping()
+    {
+        auto now = now_ms();
+        stat_pings++;
+        pings_++;
+        if (pings_ == 1)
+        {
+            first_ping_ms_ = now;
+            printf("[%d] ping %.1f s after connect\n", id_, (now - connected_ms_) / 1000.0);
+        }
+        else
+        {
+            printf("[%d] ping after %.1f s\n", id_, (now - last_ping_ms_) / 1000.0);
+        }
+        last_ping_ms_ = now;
+    }
+
+    bool has_valid_token()
+    {
+        std::lock_guard<std::mutex> lock(token_mutex_);
+        return is_token_valid(token_);
+    }
+
+    bool send_frame(uint8_t op_code, bool fin, const std::string &payload)
+    {
+        std::string frame;
+        frame += (char)((fin ? 0x80 : 0) | op_code);
+        if (payload.size() < 126)
+        {
+            frame += (char)payload.size();
+        }
+        else if (payload.size() < 65536)
+        {
+            frame += (char)126;
+            frame += (char)(payload.size() >> 8);
+            frame += (char)(payload.size() & 0xFF);
+        }
+        else
+        {
+            frame += (char)127;
+            for (int i = 7; i >= 0; i--)
+            {
+                frame += (char)(((uint64_t)payload.size() >> (i * 8)) & 0xFF);
+            }
+        }
+        frame += payload;
+
+        if (options.chunk <= 0)
+        {
+            return send_all(fd_, frame.data(), frame.size());
+        }
+
+        // simulate slow link - receiver gets frame in several TCP segments
+        for (size_t offset = 0; offset < frame.size(); offset += options.chunk)
+        {
+            size_t len = std::min(frame.size() - offset, (size_t)options.chunk);
+            if (!send_all(fd_, frame.data() + offset, len))
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return true;
+    }
+
+    bool send_text(const std::string &text)
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        bool ret = true;
+
+        if (is_stalled())
+        {
+            return true;
+        }
+
+        if (options.verbose)
+        {
+            printf("[%d] >> %s\n", id_, text.c_str());
+        }
+
+        if (options.fragment <= 0 || (int)text.size() <= options.fragment)
+        {
+            ret = send_frame(0x1, true, text);
+        }
+        else
+        {
+            for (size_t offset = 0; offset < text.size() && ret; offset += options.fragment)
+            {
+                bool last = offset + options.fragment >= text.size();
+                ret = send_frame(offset == 0 ? 0x1 : 0x0, last, text.substr(offset, options.fragment));
+            }
+        }
+
+        stat_bytes += text.size();
+        return ret;
+    }
+
+    void disconnect(bool graceful)
+    {
+        if (graceful)
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            send_frame(0x8, true, std::string("\x03\xE9", 2)); // 1001 going away
+        }
+        else
+        {
+            struct linger reset = {1, 0};
+            setsockopt(fd_, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        }
+        shutdown(fd_, SHUT_RDWR);
+    }
+
+    void receive()
+    {
+        std::string message;
+
+        while (running_)
+        {
+            uint8_t header[2];
+            if (!recv_all(fd_, (char *)header, 2))
+            {
+                break;
+            }
+
+            uint8_t op_code = header[0] & 0x0F;
+            bool fin = header[0] & 0x80;
+            uint64_t length = header[1] & 0x7F;
+            if (length == 126 || length == 127)
+            {
+                uint8_t extended[8];
+                int count = length == 126 ? 2 : 8;
+                if (!recv_all(fd_, (char *)extended, count))
+                {
+                    break;
+                }
+                length = 0;
+                for (int i = 0; i < count; i++)
+                {
+                    length = (length << 8) | extended[i];
+                }
+            }
+
+            uint8_t mask[4] = {0, 0, 0, 0};
+            if ((header[1] & 0x80) && !recv_all(fd_, (char *)mask, 4))
+            {
+                break;
+            }
+
+            if (length > 1024 * 1024)
+            {
+                break;
+            }
+
+            std::string payload(length, '\0');
+            if (length > 0 && !recv_all(fd_, &payload[0], length))
+            {
+                break;
+            }
+            for (size_t i = 0; i < payload.size(); i++)
+            {
+                payload[i] ^= mask[i % 4];
+            }
+
+            if (op_code == 0x8)
+            {
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                send_frame(0x8, true, payload.substr(0, 2));
+                break;
+            }
+            else if (op_code == 0x9)
+            {
+                handle_ping();
+                if (!is_stalled())
+                {
+                    std::lock_guard<std::mutex> lock(send_mutex_);
+                    send_frame(0xA, true, payload);
+                }
+            }
+            else if (op_code == 0x1 || op_code == 0x0)
+            {
+                message += payload;
+                if (fin)
+                {
+                    handle_message(message);
+                    message.clear();
+                }
+            }
+        }
+    }
+
+    void handle_message(const std::string &text)
+    {
+        if (options.verbose)
+        {
+            printf("[%d] << %s\n", id_, text.c_str());
+        }
+
+        JsonValue_t json;
+        JsonReader reader(text);
+        if (!reader.parse(json) || json.type != JsonValue_t::Object)
+        {
+            printf("[%d] invalid message: %s\n", id_, text.c_str());
+            return;
+        }
+
+        auto request_id = json.get_string("requestId");
+
+        if (json.get("accessRequest") != nullptr)
+        {
+            handle_access_request(request_id);
+        }
+        else if (json.get("put") != nullptr)
+        {
+            handle_put(request_id, *json.get("put"));
+        }
+        else if (json.get("subscribe") != nullptr || json.get("unsubscribe") != nullptr)
+        {
+            if (!has_valid_token())
+            {
+                printf("[%d] subscription without valid token ignored\n", id_);
+                return;
+            }
+            handle_subscriptions(json);
+        }
+        else if (json.get("updates") != nullptr)
+        {
+            // status messages sent by the watch
+            stat_deltas++;
+        }
+    }
+
+    void handle_access_request(const std::string &request_id)
+    {
+        printf("[%d] access request %s (%s)\n", id_, request_id.c_str(), options.approve.c_str());
+        send_text("{\"requestId\":\"" + json_escape(request_id) + "\",\"state\":\"PENDING\",\"href\":\"/signalk/v1/access/requests/" +
+                  json_escape(request_id) + "\"}");
+
+        if (options.approve == "none")
+        {
+            return;
+        }
+
+        workers_.push_back(std::thread([this, request_id]()
+                                       {
+                                           auto until = now_ms() + options.approve_delay;
+                                           while (running_ && now_ms() < until)
+                                           {
+                                               std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                                           }
+                                           if (!running_)
+                                           {
+                                               return;
+                                           }
+
+                                           std::string access;
+                                           if (options.approve == "deny")
+                                           {
+                                               access = "{\"permission\":\"DENIED\"}";
+                                           }
+                                           else
+                                           {
+                                               auto token = "standin-token-" + std::to_string(++token_counter);
+                                               {
+                                                   std::lock_guard<std::mutex> lock(tokens_mutex);
+                                                   tokens.insert(token);
+                                               }
+                                               {
+                                                   std::lock_guard<std::mutex> lock(token_mutex_);
+                                                   token_ = token;
+                                               }
+                                               access = "{\"permission\":\"APPROVED\",\"token\":\"" + token + "\",\"expirationTime\":\"2099-01-01T00:00:00.000Z\"}";
+                                           }
+                                           send_text("{\"requestId\":\"" + json_escape(request_id) + "\",\"state\":\"COMPLETED\",\"statusCode\":200,\"accessRequest\":" + access + "}");
+                                       }));
+    }
+
+    void handle_put(const std::string &request_id, const JsonValue_t &put)
+    {
+        auto path = put.get_string("path");
+        auto value = put.get("value");
+        int status = 200;
+
+        if (!has_valid_token())
+        {
+            status = 401;
+        }
+        else if (value == nullptr || !model.set_value(path, value->text))
+        {
+            status = 405;
+        }
+
+        printf("[%d] PUT %s = %s -> %d\n", id_, path.c_str(), value != nullptr ? value->text.c_str() : "null", status);
+        send_text("{\"requestId\":\"" + json_escape(request_id) + "\",\"state\":\"COMPLETED\",\"statusCode\":" + std::to_string(status) + "}");
+
+        if (status == 200)
+        {
+            // the new value is sent back as delta (as real server does through the provider)
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            auto range = subscriptions_.equal_range(path);
+            for (auto subscription = range.first; subscription != range.second; subscription++)
+            {
+                subscription->second.next_send = 0;
+            }
+        }
+    }
+
+    void handle_subscriptions(const JsonValue_t &json)
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        auto unsubscribe = json.get("unsubscribe");
+        if (unsubscribe != nullptr)
+        {
+            if (json.get_string("context") == "*" && unsubscribe->items.size() == 1 && unsubscribe->items[0].get_string("path") == "*")
+            {
+                subscriptions_.clear();
+            }
+            else
+            {
+                printf("[%d] unsubscribe ignored, only unsubscribe of all paths in all contexts is supported\n", id_);
+            }
+        }
+
+        auto subscribe = json.get("subscribe");
+        if (subscribe != nullptr)
+        {
+            for (auto &item : subscribe->items)
+            {
+                auto path = item.get_string("path");
+                auto period = item.get("period");
+                Subscription_t subscription;
+                subscription.period = period != nullptr ? (uint32_t)period->number : 1000;
+                if (subscription.period < 100)
+                {
+                    subscription.period = 100;
+                }
+                subscription.next_send = 0;
+                subscriptions_.insert(std::make_pair(path, subscription));
+            }
+        }
+
+        printf("[%d] %zu subscriptions\n", id_, subscriptions_.size());
+    }
+
+    /// Collects paths whose subscription is due (or next round robin batch in --rate mode)
+    std::vector<std::string> due_paths(uint64_t now, size_t &round_robin)
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        std::vector<std::string> ret;
+        std::vector<std::string> matching;
+
+        for (auto &subscription : subscriptions_)
+        {
+            bool rate_mode = options.rate > 0;
+            if (!rate_mode && subscription.second.next_send > now)
+            {
+                continue;
+            }
+
+            for (auto &path : model_paths_)
+            {
+                bool wildcard = subscription.first.size() > 0 && subscription.first.back() == '*';
+                if (path == subscription.first || (wildcard && path.compare(0, subscription.first.size() - 1, subscription.first, 0, subscription.first.size() - 1) == 0))
+                {
+                    matching.push_back(path);
+                }
+            }
+            subscription.second.next_send = now + subscription.second.period;
+        }
+
+        if (options.rate > 0)
+        {
+            for (int i = 0; i < options.values && !matching.empty(); i++)
+            {
+                ret.push_back(matching[round_robin++ % matching.size()]);
+            }
+        }
+        else
+        {
+            ret = matching;
+        }
+
+        return ret;
+    }
+
+    void generate()
+    {
+        model_paths_ = model.get_paths();
+        size_t round_robin = 0;
+        uint32_t drops = drop_generation;
+        uint32_t notifications = notification_generation;
+        uint64_t interval_us = options.rate > 0 ? 1000000 / options.rate : 50000;
+        auto next = std::chrono::steady_clock::now();
+        double ais_due = 0;
+        uint32_t ais_target = 0;
+
+        while (running_)
+        {
+            next += std::chrono::microseconds(interval_us);
+            std::this_thread::sleep_until(next);
+
+            if (drops != drop_generation)
+            {
+                printf("[%d] dropping connection (%s)\n", id_, options.drop_mode.c_str());
+                disconnect(options.drop_mode == "close");
+                break;
+            }
+
+            if (notifications != notification_generation)
+            {
+                notifications = notification_generation;
+                bool alarm = notifications % 2 == 1;
+                send_text("{\"context\":\"" + std::string(SELF_CONTEXT) + "\",\"updates\":[{\"timestamp\":\"" + iso_timestamp() +
+                          "\",\"values\":[{\"path\":\"notifications.standin.alarm\",\"value\":{\"state\":\"" + (alarm ? "alarm" : "normal") +
+                          "\",\"method\":[\"visual\",\"sound\"],\"message\":\"Stand-in alarm " + std::to_string(notifications) + "\"}}]}]}");
+            }
+
+            if (options.ais > 0)
+            {
+                ais_due += options.ais * interval_us / 1000000.0;
+                for (; ais_due >= 1; ais_due -= 1)
+                {
+                    if (!send_text(ais_delta(ais_target++ % 100)))
+                    {
+                        return;
+                    }
+                    stat_deltas++;
+                }
+            }
+
+            auto paths = due_paths(now_ms(), round_robin);
+            if (paths.empty())
+            {
+                continue;
+            }
+
+            std::string delta = "{\"context\":\"" + std::string(SELF_CONTEXT) + "\",\"updates\":[{\"source\":{\"label\":\"standin\"},\"timestamp\":\"" +
+                                iso_timestamp() + "\",\"values\":[";
+            for (size_t i = 0; i < paths.size(); i++)
+            {
+                if (i > 0)
+                {
+                    delta += ",";
+                }
+                delta += "{\"path\":\"" + paths[i] + "\",\"value\":" + model.next_value(paths[i]) + "}";
+            }
+            delta += "]}]}";
+
+            if (!send_text(delta))
+            {
+                break;
+            }
+            stat_deltas++;
+        }
+    }
+
+    std::vector<std::string> model_paths_;
+
+    static std::string ais_delta(uint32_t target)
+    {
+        char buffer[640];
+        double drift = (now_ms() % 3600000) / 3600000.0;
+        snprintf(buffer, sizeof(buffer),
+                 "{\"context\":\"vessels.urn:mrn:imo:mmsi:2300%05u\",\"updates\":[{\"source\":{\"label\":\"ais\",\"type\":\"NMEA0183\","
+                 "\"talker\":\"AI\",\"sentence\":\"VDM\"},\"timestamp\":\"%s\",\"values\":["
+                 "{\"path\":\"navigation.position\",\"value\":{\"longitude\":%.6f,\"latitude\":%.6f}},"
+                 "{\"path\":\"navigation.courseOverGroundTrue\",\"value\":%.4f},"
+                 "{\"path\":\"navigation.speedOverGround\",\"value\":%.2f},"
+                 "{\"path\":\"navigation.headingTrue\",\"value\":%.4f},"
+                 "{\"path\":\"\",\"value\":{\"mmsi\":\"2300%05u\",\"name\":\"TARGET %u\"}}]}]}",
+                 target, iso_timestamp().c_str(), 24.9 + target * 0.001 + drift * 0.01, 60.1 + target * 0.0005, (target % 63) * 0.1,
+                 (target % 12) * 0.5, (target % 63) * 0.1, target, target);
+        return buffer;
+    }
+};
+
+/*
+ * HTTP server.
+ */
+static void send_http(int fd, int status, const char *status_text, const std::string &content_type, const std::string &body)
+{
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + status_text + "\r\nContent-Type: " + content_type +
+                           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    send_all(fd, response.data(), response.size());
+}
+
+static std::string header_value(const std::string &request, const char *name)
+{
+    std::string lower = request;
+    std::string key = std::string("\r\n") + name + ":";
+    for (auto &c : lower)
+    {
+        c = tolower(c);
+    }
+    for (auto &c : key)
+    {
+        c = tolower(c);
+    }
+    auto pos = lower.find(key);
+    if (pos == std::string::npos)
+    {
+        return "";
+    }
+    pos += key.size();
+    auto end = request.find("\r\n", pos);
+    auto value = request.substr(pos, end - pos);
+    value.erase(0, value.find_first_not_of(' '));
+    value.erase(value.find_last_not_of(' ') + 1);
+    return value;
+}
+
+static std::string bearer_token(const std::string &request)
+{
+    auto authorization = header_value(request, "Authorization");
+    if (authorization.compare(0, 7, "Bearer ") == 0)
+    {
+        return authorization.substr(7);
+    }
+    return "";
+}
+
+static void handle_client(int fd, int id)
+{
+    std::string request;
+    char buffer[1024];
+
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16384)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            close(fd);
+            return;
+        }
+        request.append(buffer, received);
+    }
+
+    std::istringstream line(request.substr(0, request.find("\r\n")));
+    std::string method, target;
+    line >> method >> target;
+    auto path = target.substr(0, target.find('?'));
+    printf("[%d] %s %s\n", id, method.c_str(), target.c_str());
+
+    if (path == "/signalk/v1/stream" && !header_value(request, "Sec-WebSocket-Key").empty())
+    {
+        auto token = query_param(target, "token");
+        if (token.empty())
+        {
+            token = bearer_token(request);
+        }
+
+        auto accept = base64(sha1(header_value(request, "Sec-WebSocket-Key") + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + accept + "\r\n\r\n";
+        send_all(fd, response.data(), response.size());
+
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        WebsocketSession session(fd, token, id);
+        session.run();
+        return;
+    }
+
+    if (path == "/signalk" || path == "/signalk/")
+    {
+        send_http(fd, 200, "OK", "application/json",
+                  "{\"endpoints\":{\"v1\":{\"version\":\"1.0.0\",\"signalk-http\":\"http://" + header_value(request, "Host") +
+                      "/signalk/v1/api/\",\"signalk-ws\":\"ws://" + header_value(request, "Host") + "/signalk/v1/stream\"}},\"server\":{\"id\":\"signalk-standin\",\"version\":\"1.0.0\"}}");
+    }
+    else if (!is_token_valid(bearer_token(request)))
+    {
+        send_http(fd, 401, "Unauthorized", "text/plain", "Unauthorized");
+    }
+    else if (path == "/signalk/v1/api/vessels/self" || path == "/signalk/v1/api/vessels/self/")
+    {
+        send_http(fd, 200, "OK", "application/json", model.to_json());
+    }
+    else if (path == "/signalk/v1/api" || path == "/signalk/v1/api/")
+    {
+        send_http(fd, 200, "OK", "application/json",
+                  "{\"version\":\"1.0.0\",\"self\":\"" + std::string(SELF_CONTEXT) + "\",\"vessels\":{\"" + std::string(SELF_CONTEXT + 8) + "\":" + model.to_json() + "}}");
+    }
+    else if (path == "/signalk/v1/applicationData/global/twatch/1.0/ui/default")
+    {
+        std::ifstream file(options.view);
+        if (file)
+        {
+            std::stringstream content;
+            content << file.rdbuf();
+            send_http(fd, 200, "OK", "application/json", content.str());
+        }
+        else
+        {
+            send_http(fd, 404, "Not Found", "text/plain", "View file not found");
+        }
+    }
+    else
+    {
+        send_http(fd, 404, "Not Found", "text/plain", "Not found");
+    }
+
+    close(fd);
+}
+
+static void print_stats()
+{
+    uint64_t last_deltas = 0;
+    uint64_t last_bytes = 0;
+    uint64_t last_pings = 0;
+    uint64_t elapsed = 0;
+
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        elapsed++;
+
+        if (options.drop_every > 0 && elapsed % options.drop_every == 0)
+        {
+            drop_generation++;
+        }
+
+        if (options.notify_every > 0 && elapsed % options.notify_every == 0)
+        {
+            notification_generation++;
+        }
+
+        if (elapsed % 5 == 0)
+        {
+            uint64_t deltas = stat_deltas;
+            uint64_t bytes = stat_bytes;
+            uint64_t pings = stat_pings;
+            printf("stats: clients=%d connections=%u deltas/s=%.1f kB/s=%.1f pings/min=%.1f\n", (int)stat_clients, (unsigned)stat_connections,
+                   (deltas - last_deltas) / 5.0, (bytes - last_bytes) / 5120.0, (pings - last_pings) * 12.0);
+            last_deltas = deltas;
+            last_bytes = bytes;
+            last_pings = pings;
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [--port N] [--paths N] [--rate N] [--values N] [--fragment N] [--chunk N]\n"
+           "          [--approve auto|deny|none] [--approve-delay MS] [--require-token] [--token TOKEN]\n"
+           "          [--drop-every S] [--drop-mode abrupt|close] [--notify-every S] [--ais N] [--stall S]\n"
+           "          [--view FILE] [--verbose]\n",
+           name);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--port" && has_value)
+            options.port = atoi(argv[++i]);
+        else if (arg == "--paths" && has_value)
+            options.paths = atoi(argv[++i]);
+        else if (arg == "--rate" && has_value)
+            options.rate = atoi(argv[++i]);
+        else if (arg == "--values" && has_value)
+            options.values = atoi(argv[++i]);
+        else if (arg == "--fragment" && has_value)
+            options.fragment = atoi(argv[++i]);
+        else if (arg == "--chunk" && has_value)
+            options.chunk = atoi(argv[++i]);
+        else if (arg == "--approve" && has_value)
+            options.approve = argv[++i];
+        else if (arg == "--approve-delay" && has_value)
+            options.approve_delay = atoi(argv[++i]);
+        else if (arg == "--require-token")
+            options.require_token = true;
+        else if (arg == "--token" && has_value)
+            tokens.insert(argv[++i]);
+        else if (arg == "--drop-every" && has_value)
+            options.drop_every = atoi(argv[++i]);
+        else if (arg == "--drop-mode" && has_value)
+            options.drop_mode = argv[++i];
+        else if (arg == "--notify-every" && has_value)
+            options.notify_every = atoi(argv[++i]);
+        else if (arg == "--ais" && has_value)
+            options.ais = atoi(argv[++i]);
+        else if (arg == "--stall" && has_value)
+            options.stall = atoi(argv[++i]);
+        else if (arg == "--view" && has_value)
+            options.view = argv[++i];
+        else if (arg == "--verbose")
+            options.verbose = true;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    model.generate(options.paths);
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(options.port);
+
+    if (bind(server, (sockaddr *)&address, sizeof(address)) != 0 || listen(server, 16) != 0)
+    {
+        perror("Unable to listen");
+        return 1;
+    }
+
+    printf("SignalK stand-in listening on port %d with %d paths (rate=%d, fragment=%d, approve=%s)\n", options.port,
+           options.paths, options.rate, options.fragment, options.approve.c_str());
+    std::thread(print_stats).detach();
+
+    while (true)
+    {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+        std::thread(handle_client, client, (int)++stat_connections).detach();
+    }
+}
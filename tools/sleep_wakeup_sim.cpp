@@ -0,0 +1,229 @@
+/*
+ * Host simulation of CPU wakeups caused by Hardware::low_energy sleep loop while the watch is asleep.
+ *
+ * It replays the same night (random wake up events - notifications, wrist tilts, button presses) through:
+ *  - polling loop: delay(500) and check of event bits on every pass (original implementation)
+ *  - event-driven loop: xEventGroupWaitBits with timeout computed to the next low power tick
+ *  - job timers: every low power job (period, slack) wakes the CPU at its due time on its own
+ *  - batched jobs: LowPowerScheduler wakes at the earliest window end and runs all jobs due by then
+ * and prints wakeups per hour and latency of reaction to wake up events.
+ *
+ * Build and run on Linux (no dependencies):
+ *    g++ -std=c++11 -O2 -o sleep_wakeup_sim tools/sleep_wakeup_sim.cpp
+ *    ./sleep_wakeup_sim --hours 8 --events 4 --tick 5000
+ *
+ * Options:
+ *    --hours N    simulated time asleep (default 8)
+ *    --events N   wake up events per hour (default 2)
+ *    --tick MS    period of low power tick of polling and event-driven loop (default 5000)
+ *    --job P:S    low power job with period P ms and slack S ms, can be repeated
+ *                 (default 5000:3000 and 60000:15000 - websocket ping delay and status message)
+ *    --seed N     random seed (default 1)
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+struct Options_t
+{
+    double hours = 8;
+    double events = 2;
+    uint64_t tick = 5000;
+    unsigned seed = 1;
+    std::vector<std::pair<uint64_t, uint64_t>> jobs;
+};
+
+struct Result_t
+{
+    uint64_t wakeups = 0;
+    uint64_t ticks = 0;
+    uint64_t latency_total = 0;
+    uint64_t latency_max = 0;
+};
+
+/// Original loop: wakes every 500 ms, tick callbacks every 10th pass, event is noticed on the next pass
+static Result_t simulate_polling(const std::vector<uint64_t> &events, uint64_t duration, uint64_t tick)
+{
+    Result_t ret;
+    uint64_t counter = 0;
+    size_t next_event = 0;
+
+    for (uint64_t now = 500; now <= duration; now += 500)
+    {
+        ret.wakeups++;
+        counter++;
+
+        while (next_event < events.size() && events[next_event] <= now)
+        {
+            uint64_t latency = now - events[next_event];
+            ret.latency_total += latency;
+            ret.latency_max = std::max(ret.latency_max, latency);
+            next_event++;
+        }
+
+        if ((counter * 500) % tick == 0)
+        {
+            ret.ticks++;
+        }
+    }
+
+    return ret;
+}
+
+/// Event-driven loop: wakes at the event (interrupt sets bit) or at deadline of the next tick
+static Result_t simulate_event_driven(const std::vector<uint64_t> &events, uint64_t duration, uint64_t tick)
+{
+    Result_t ret;
+    uint64_t next_tick = tick;
+    size_t next_event = 0;
+    uint64_t now = 0;
+
+    while (now < duration)
+    {
+        uint64_t wake = std::min(next_tick, duration);
+        if (next_event < events.size() && events[next_event] < wake)
+        {
+            wake = events[next_event];
+            // watch leaves the loop immediately and comes back after the event is handled
+            next_event++;
+        }
+
+        now = wake;
+        ret.wakeups++;
+
+        if (now >= next_tick)
+        {
+            ret.ticks++;
+            next_tick += tick;
+        }
+    }
+
+    return ret;
+}
+
+/// Jobs scheduled by LowPowerScheduler, batched = false wakes the CPU at due time of every job separately
+static Result_t simulate_jobs(const std::vector<uint64_t> &events, uint64_t duration, const std::vector<std::pair<uint64_t, uint64_t>> &jobs, bool batched)
+{
+    Result_t ret;
+    std::vector<uint64_t> due;
+    size_t next_event = 0;
+    uint64_t now = 0;
+
+    for (auto &job : jobs)
+    {
+        due.push_back(job.first);
+    }
+
+    while (now < duration)
+    {
+        uint64_t wake = duration;
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            wake = std::min(wake, due[i] + (batched ? jobs[i].second : 0));
+        }
+
+        if (next_event < events.size() && events[next_event] < wake)
+        {
+            wake = events[next_event];
+            next_event++;
+        }
+
+        now = wake;
+        ret.wakeups++;
+
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            if (due[i] <= now)
+            {
+                ret.ticks++;
+                due[i] += jobs[i].first;
+                if (due[i] <= now)
+                {
+                    due[i] = now + jobs[i].first;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+static void print_result(const char *name, const Result_t &result, double hours, size_t events)
+{
+    printf("%-14s wakeups/h=%9.1f  jobs/h=%8.1f  event latency avg=%6.1f ms max=%4llu ms\n", name, result.wakeups / hours,
+           result.ticks / hours, events > 0 ? (double)result.latency_total / events : 0.0, (unsigned long long)result.latency_max);
+}
+
+int main(int argc, char **argv)
+{
+    Options_t options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--hours") == 0 && has_value)
+            options.hours = atof(argv[++i]);
+        else if (strcmp(argv[i], "--events") == 0 && has_value)
+            options.events = atof(argv[++i]);
+        else if (strcmp(argv[i], "--tick") == 0 && has_value)
+            options.tick = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && has_value)
+            options.seed = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--job") == 0 && has_value)
+        {
+            char *slack = NULL;
+            uint64_t period = strtoull(argv[++i], &slack, 10);
+            options.jobs.push_back(std::make_pair(period, *slack == ':' ? strtoull(slack + 1, NULL, 10) : 0));
+        }
+        else
+        {
+            printf("Usage: %s [--hours N] [--events N] [--tick MS] [--seed N] [--job PERIOD:SLACK]...\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.jobs.empty())
+    {
+        options.jobs.push_back(std::make_pair(5000, 3000));
+        options.jobs.push_back(std::make_pair(60000, 15000));
+    }
+
+    for (auto &job : options.jobs)
+    {
+        if (job.first == 0)
+        {
+            printf("Job period has to be greater than 0.\n");
+            return 1;
+        }
+    }
+
+    if (options.tick < 500 || options.tick % 500 != 0)
+    {
+        printf("Tick has to be multiple of 500 ms.\n");
+        return 1;
+    }
+
+    uint64_t duration = (uint64_t)(options.hours * 3600000);
+    std::mt19937 random(options.seed);
+    std::exponential_distribution<double> gap(options.events / 3600000.0);
+    std::vector<uint64_t> events;
+
+    for (double time = gap(random); options.events > 0 && time < duration; time += gap(random))
+    {
+        events.push_back((uint64_t)time);
+    }
+
+    printf("Simulated %.1f h asleep, %zu wake up events, low power tick %llu ms\n", options.hours, events.size(),
+           (unsigned long long)options.tick);
+    print_result("polling", simulate_polling(events, duration, options.tick), options.hours, events.size());
+    print_result("event-driven", simulate_event_driven(events, duration, options.tick), options.hours, events.size());
+    print_result("job timers", simulate_jobs(events, duration, options.jobs, false), options.hours, events.size());
+    print_result("batched jobs", simulate_jobs(events, duration, options.jobs, true), options.hours, events.size());
+
+    return 0;
+}